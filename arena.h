@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_ARENA_H
+#define IMM_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace l {
+
+// bump allocator, memory is only given back when the arena is cleared or
+// destroyed. objects that are not trivially destructible are registered
+// and destroyed in reverse order of creation. not thread safe.
+class arena {
+public:
+    explicit arena(std::size_t block_size = 4096) noexcept
+    : block_size_(block_size) {}
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+    ~arena() { clear(); }
+
+    void* allocate(std::size_t size, std::size_t align) {
+        auto p = (cur_ + (align - 1)) & ~static_cast<std::uintptr_t>(align - 1);
+        if (cur_ == 0 || p + size > end_) {
+            new_block_(size + align);
+            p = (cur_ + (align - 1)) & ~static_cast<std::uintptr_t>(align - 1);
+        }
+        cur_ = p + size;
+        used_ += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        void* mem = allocate(sizeof(T), alignof(T));
+        T* obj = new (mem) T(std::forward<Args>(args)...);
+        destroy_later(obj, 1);
+        return obj;
+    }
+
+    // the n objects constructed by the caller at p, in memory given by
+    // allocate, are destroyed with the arena.
+    template <typename T>
+    void destroy_later(T* p, std::size_t n) {
+        if (std::is_trivially_destructible<T>::value || n == 0) { return; }
+        void* c = allocate(sizeof(cleanup_), alignof(cleanup_));
+        cleanups_ = new (c) cleanup_{p, n, &destroy_<T>, cleanups_};
+    }
+
+    void clear() noexcept {
+        for (auto c = cleanups_; c != nullptr; c = c->next) { c->destroy(c->obj, c->n); }
+        cleanups_ = nullptr;
+        while (blocks_ != nullptr) {
+            auto next = blocks_->next;
+            ::operator delete(blocks_);
+            blocks_ = next;
+        }
+        cur_ = end_ = 0;
+        used_ = 0;
+    }
+
+    std::size_t bytes_used() const noexcept { return used_; }
+
+private:
+    struct block_ { block_* next; };
+    struct cleanup_ {
+        void* obj;
+        std::size_t n;
+        void (*destroy)(void*, std::size_t);
+        cleanup_* next;
+    };
+
+    template <typename T>
+    static void destroy_(void* p, std::size_t n) {
+        while (n > 0) { static_cast<T*>(p)[--n].~T(); }
+    }
+
+    void new_block_(std::size_t min_size) {
+        auto size = sizeof(block_) + (min_size > block_size_ ? min_size : block_size_);
+        auto b = static_cast<block_*>(::operator new(size));
+        b->next = blocks_;
+        blocks_ = b;
+        cur_ = reinterpret_cast<std::uintptr_t>(b + 1);
+        end_ = reinterpret_cast<std::uintptr_t>(b) + size;
+    }
+
+    std::size_t block_size_;
+    std::size_t used_ = 0;
+    std::uintptr_t cur_ = 0;
+    std::uintptr_t end_ = 0;
+    block_* blocks_ = nullptr;
+    cleanup_* cleanups_ = nullptr;
+};
+
+} // l
+
+#endif // IMM_ARENA_H
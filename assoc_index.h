@@ -0,0 +1,160 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_ASSOC_INDEX_H
+#define IMM_ASSOC_INDEX_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <sort.h>
+#include <tuple>
+
+namespace l {
+
+class duplicate_key: public std::exception {
+public:
+    std::string what_;
+    duplicate_key() = default;
+    explicit duplicate_key(const std::string& what_arg)
+    : what_(what_arg) {}
+    virtual const char* what() const throw()
+    { if (what_ == "") {return "duplicate_key"; } else { return what_.c_str(); }}
+};
+
+// keys and values of an assoc list sorted by key, lookups are a binary
+// search. keys must be comparable with <.
+template <typename A, typename B, std::size_t N>
+struct assoc_index {
+    using key_type = A;
+    using value_type = B;
+    A keys[N];
+    B values[N];
+};
+
+// get the list size
+
+template <std::size_t N, typename A, typename B, std::size_t M>
+struct length_<N, assoc_index<A, B, M>> {
+    static constexpr std::size_t value = N + M;
+};
+
+// sorted permutation of the entries of an assoc list
+
+template <std::size_t N>
+struct assoc_index_perm_ {
+    std::size_t i[N];
+};
+
+// entries compared by key through their position in the list
+template <typename A, typename B, std::size_t N>
+struct assoc_index_less_ {
+    constexpr bool operator()(std::size_t i, std::size_t j) const
+    { return std::get<0>(l.data[i]) < std::get<0>(l.data[j]); }
+    const flat_list<std::tuple<A, B>, N>& l;
+};
+
+template <typename A, typename B, std::size_t N>
+constexpr auto assoc_index_sort_(const flat_list<std::tuple<A, B>, N>& l)
+    -> assoc_index_perm_<N>
+{
+    assoc_index_perm_<N> p{};
+    for (std::size_t i = 0; i < N; ++i) { p.i[i] = i; }
+    // the merge sort of sort.h, stable and only needs <
+    assoc_index_less_<A, B, N> less{l};
+    sort_(p.i, less);
+    // duplicated keys are adjacent once sorted, throwing here is a
+    // compilation error when the index is built in a constant expression.
+    for (std::size_t i = 1; i < N; ++i) {
+        if (not (std::get<0>(l.data[p.i[i - 1]]) < std::get<0>(l.data[p.i[i]]))) {
+            throw duplicate_key{};
+        }
+    }
+    return p;
+}
+
+template <typename A, typename B, std::size_t N, std::size_t... I>
+constexpr auto make_assoc_index_(const flat_list<std::tuple<A, B>, N>& l,
+                                 const assoc_index_perm_<N>& p,
+                                 std::index_sequence<I...>)
+    -> assoc_index<A, B, N>
+{
+    return assoc_index<A, B, N>{
+        {std::get<0>(l.data[p.i[I]])...},
+        {std::get<1>(l.data[p.i[I]])...}
+    };
+}
+
+template <typename A, typename B, std::size_t N>
+constexpr auto make_assoc_index(const flat_list<std::tuple<A, B>, N>& l)
+    -> assoc_index<A, B, N>
+{ return make_assoc_index_(l, assoc_index_sort_(l), std::make_index_sequence<N>{}); }
+
+// build from an assoc list, throws duplicate_key if a key appears twice
+template <typename A,
+          typename B,
+          typename Tail>
+constexpr auto make_assoc_index(const cons_<std::tuple<A, B>, Tail>& l)
+    -> assoc_index<A, B, length<cons_<std::tuple<A, B>, Tail>>::value>
+{ return make_assoc_index(to_flat(l)); }
+
+// position of the first key not less than a
+
+template <typename A, typename B, std::size_t N>
+constexpr std::size_t assoc_index_lower_bound_(const A& a, const assoc_index<A, B, N>& l) noexcept {
+    std::size_t lo = 0;
+    std::size_t hi = N;
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        if (l.keys[mid] < a) { lo = mid + 1; } else { hi = mid; }
+    }
+    return lo;
+}
+
+// assoc
+
+template <typename A, typename B, std::size_t N>
+constexpr auto assoc(const A& a, const assoc_index<A, B, N>& l) -> B {
+    auto i = assoc_index_lower_bound_(a, l);
+    if (i == N || a < l.keys[i]) { throw not_found{}; }
+    return l.values[i];
+}
+
+// assoc_opt, pointer to the value or nullptr
+
+template <typename A, typename B, std::size_t N>
+constexpr const B* assoc_opt(const A& a, const assoc_index<A, B, N>& l) noexcept {
+    auto i = assoc_index_lower_bound_(a, l);
+    if (i == N || a < l.keys[i]) { return nullptr; }
+    return &l.values[i];
+}
+
+// mem_assoc
+
+template <typename A, typename B, std::size_t N>
+constexpr bool mem_assoc(const A& a, const assoc_index<A, B, N>& l) noexcept {
+    auto i = assoc_index_lower_bound_(a, l);
+    return i != N && not (a < l.keys[i]);
+}
+
+} // l
+
+#endif // IMM_ASSOC_INDEX_H
@@ -0,0 +1,305 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_ATOMIC_LIST_H
+#define IMM_ATOMIC_LIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace l {
+
+// holder of an immutable list shared between threads and replaced as a
+// whole. readers take a snapshot without locking: it pins the current
+// epoch then loads the list pointer, a bounded number of steps (wait
+// free). writers publish a new list with one atomic exchange. the list
+// replaced is retired and only deleted once every reader pinned at that
+// time has released its snapshot (epoch based reclamation).
+
+// reclamation state shared by all the atomic_list of the process.
+//
+// a reader announces the global epoch in its slot while it holds a
+// snapshot. the epoch is advanced only when every pinned reader has seen
+// the current one, so a list retired at epoch e can no longer be
+// referenced once the epoch reaches e + 2. the slot also counts the
+// snapshots pinning it, a snapshot unpins the slot it pinned even when it
+// is moved to another thread.
+class epoch_domain_ {
+public:
+    static constexpr std::size_t max_threads = 256;
+
+    struct retired_ {
+        retired_* next;
+        std::uint64_t epoch;
+        void (*destroy)(retired_*);
+    };
+
+    static epoch_domain_& instance() {
+        static epoch_domain_ d;
+        return d;
+    }
+
+    epoch_domain_(const epoch_domain_&) = delete;
+    epoch_domain_& operator=(const epoch_domain_&) = delete;
+
+    // threads exited, nothing can be pinned anymore
+    ~epoch_domain_() {
+        free_all_(retired_head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    // pin the slot of the current thread, returned for unpin. the first
+    // pin announces the epoch, the next ones only count.
+    std::size_t pin() {
+        auto slot = local_().slot;
+        auto& state = slots_[slot].state;
+        auto s = state.load(std::memory_order_relaxed);
+        std::uint64_t next;
+        do {
+            next = (s & count_mask_) != 0
+                 ? s + 1
+                 : epoch_.load(std::memory_order_relaxed) << count_bits_ | 1;
+        // seq_cst, the announce must be visible before the list is loaded
+        } while (not state.compare_exchange_weak(s, next, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed));
+        return slot;
+    }
+
+    // from any thread, the slot may belong to another one
+    void unpin(std::size_t slot) noexcept {
+        auto& state = slots_[slot].state;
+        auto s = state.load(std::memory_order_relaxed);
+        while (not state.compare_exchange_weak(s, (s & count_mask_) == 1 ? 0 : s - 1,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {}
+    }
+
+    struct guard {
+        explicit guard(epoch_domain_& d)
+        : d(d), slot(d.pin()) {}
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+        ~guard() { d.unpin(slot); }
+        epoch_domain_& d;
+        std::size_t slot;
+    };
+
+    void retire(retired_* r) noexcept {
+        r->epoch = epoch_.load(std::memory_order_seq_cst);
+        auto head = retired_head_.load(std::memory_order_relaxed);
+        do { r->next = head; }
+        while (not retired_head_.compare_exchange_weak(head, r, std::memory_order_release,
+                                                       std::memory_order_relaxed));
+        if (retired_count_.fetch_add(1, std::memory_order_relaxed) % reclaim_period == 0) {
+            reclaim();
+        }
+    }
+
+    // try to advance the epoch then delete what is old enough, skipped if
+    // another thread is already reclaiming
+    void reclaim() noexcept {
+        if (reclaiming_.exchange(true, std::memory_order_acquire)) { return; }
+        try_advance_();
+        auto e = epoch_.load(std::memory_order_seq_cst);
+        auto r = retired_head_.exchange(nullptr, std::memory_order_acquire);
+        while (r != nullptr) {
+            auto next = r->next;
+            if (r->epoch + 2 <= e) {
+                r->destroy(r);
+                retired_count_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                auto head = retired_head_.load(std::memory_order_relaxed);
+                do { r->next = head; }
+                while (not retired_head_.compare_exchange_weak(head, r, std::memory_order_release,
+                                                               std::memory_order_relaxed));
+            }
+            r = next;
+        }
+        reclaiming_.store(false, std::memory_order_release);
+    }
+
+    // lists retired and not deleted yet
+    std::size_t pending() const noexcept
+    { return retired_count_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t reclaim_period = 64;
+
+    // a thread holds less than 2^24 snapshots at once
+    static constexpr unsigned count_bits_ = 24;
+    static constexpr std::uint64_t count_mask_ = (std::uint64_t{1} << count_bits_) - 1;
+
+    // one cache line per slot, written by its thread and the threads its
+    // snapshots were moved to
+    struct alignas(64) slot_ {
+        // 0 when not pinned, epoch << count_bits_ | number of pins otherwise
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<bool> used{false};
+    };
+
+    // slot of the current thread, given back when the thread exits
+    struct local_slot_ {
+        explicit local_slot_(epoch_domain_& d)
+        : d(d), slot(d.acquire_slot_()) {}
+        ~local_slot_() { d.slots_[slot].used.store(false, std::memory_order_release); }
+        epoch_domain_& d;
+        std::size_t slot;
+    };
+
+    epoch_domain_() = default;
+
+    local_slot_& local_() {
+        thread_local local_slot_ t(*this);
+        return t;
+    }
+
+    std::size_t acquire_slot_() {
+        for (std::size_t i = 0; i < max_threads; ++i) {
+            if (not slots_[i].used.load(std::memory_order_relaxed) &&
+                not slots_[i].used.exchange(true, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+        throw std::length_error("atomic_list: more than max_threads threads");
+    }
+
+    void try_advance_() noexcept {
+        auto e = epoch_.load(std::memory_order_seq_cst);
+        for (std::size_t i = 0; i < max_threads; ++i) {
+            auto s = slots_[i].state.load(std::memory_order_seq_cst);
+            if ((s & count_mask_) != 0 && (s >> count_bits_) != e) { return; }
+        }
+        epoch_.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    }
+
+    static void free_all_(retired_* r) noexcept {
+        while (r != nullptr) {
+            auto next = r->next;
+            r->destroy(r);
+            r = next;
+        }
+    }
+
+    std::atomic<std::uint64_t> epoch_{2};
+    std::atomic<retired_*> retired_head_{nullptr};
+    std::atomic<std::size_t> retired_count_{0};
+    std::atomic<bool> reclaiming_{false};
+    slot_ slots_[max_threads];
+};
+
+template <typename L>
+struct atomic_node_ : epoch_domain_::retired_ {
+    template <typename... Args>
+    explicit atomic_node_(Args&&... args)
+    : retired_{nullptr, 0, &destroy}, value(std::forward<Args>(args)...) {}
+
+    static void destroy(epoch_domain_::retired_* r) noexcept
+    { delete static_cast<atomic_node_*>(r); }
+
+    const L value;
+};
+
+// a pinned list, valid until the snapshot is destroyed. keep it short
+// lived: while it is alive no list retired since can be deleted.
+template <typename L>
+class snapshot {
+public:
+    snapshot(const snapshot&) = delete;
+    snapshot& operator=(const snapshot&) = delete;
+    // the slot pinned moves with the snapshot, it can be destroyed on
+    // another thread
+    snapshot(snapshot&& o) noexcept
+    : n_(o.n_), pinned_(o.pinned_) { o.n_ = nullptr; }
+    ~snapshot() {
+        if (n_ != nullptr) { epoch_domain_::instance().unpin(pinned_); }
+    }
+
+    const L& get() const noexcept { return n_->value; }
+    const L& operator*() const noexcept { return n_->value; }
+    const L* operator->() const noexcept { return &n_->value; }
+
+private:
+    template <typename>
+    friend class atomic_list;
+
+    explicit snapshot(const std::atomic<const atomic_node_<L>*>& cur)
+    : n_(nullptr), pinned_(epoch_domain_::instance().pin()) {
+        n_ = cur.load(std::memory_order_seq_cst);
+    }
+
+    const atomic_node_<L>* n_;
+    std::size_t pinned_;
+};
+
+template <typename L>
+class atomic_list {
+public:
+    using value_type = L;
+
+    // the domain is created first so it is destroyed after a static atomic_list
+    explicit atomic_list(L l)
+    : cur_((epoch_domain_::instance(), new atomic_node_<L>(std::move(l)))) {}
+    atomic_list(const atomic_list&) = delete;
+    atomic_list& operator=(const atomic_list&) = delete;
+    // readers may still hold a snapshot of the last list
+    ~atomic_list() {
+        epoch_domain_::instance().retire(
+            const_cast<atomic_node_<L>*>(cur_.load(std::memory_order_acquire)));
+    }
+
+    snapshot<L> load() const
+    { return snapshot<L>(cur_); }
+
+    // publish l, the previous list is deleted once no reader uses it
+    void store(L l) {
+        auto n = new atomic_node_<L>(std::move(l));
+        auto old = cur_.exchange(n, std::memory_order_seq_cst);
+        epoch_domain_::instance().retire(const_cast<atomic_node_<L>*>(old));
+    }
+
+    // publish f(current list), f is called again if another writer
+    // published in between so it must not have side effects
+    template <typename Fn>
+    void update(Fn f) {
+        auto& d = epoch_domain_::instance();
+        const atomic_node_<L>* old;
+        {
+            epoch_domain_::guard g(d);
+            old = cur_.load(std::memory_order_seq_cst);
+            auto n = new atomic_node_<L>(f(old->value));
+            while (not cur_.compare_exchange_weak(old, n, std::memory_order_seq_cst)) {
+                delete n;
+                n = new atomic_node_<L>(f(old->value));
+            }
+        }
+        d.retire(const_cast<atomic_node_<L>*>(old));
+    }
+
+private:
+    std::atomic<const atomic_node_<L>*> cur_;
+};
+
+} // l
+
+#endif // IMM_ATOMIC_LIST_H
@@ -0,0 +1,196 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// atomic_list against a list guarded by a mutex.
+//
+// moved snapshot: a snapshot destroyed by another thread than the one
+// that took it must release its pin. stress: readers check that every
+// snapshot is a consistent table while writers keep publishing new ones,
+// then every retired table must be deleted. latency: time to read a table in the main thread while other
+// threads read and one thread writes.
+//
+//   g++ -std=c++14 -O2 -pthread -I . bench/atomic_list.cpp -o atomic_list_bench && ./atomic_list_bench
+
+#include <atomic_list.h>
+#include <list.h>
+#include <bench/bench.h>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// counts the live tables to check the reclamation
+struct route {
+    static std::atomic<long> live;
+    route(long v) : v(v) { live.fetch_add(1, std::memory_order_relaxed); }
+    route(const route& o) : v(o.v) { live.fetch_add(1, std::memory_order_relaxed); }
+    ~route() { live.fetch_sub(1, std::memory_order_relaxed); }
+    long v;
+};
+std::atomic<long> route::live{0};
+
+static long value(const route& r) { return r.v; }
+static long value(long v) { return v; }
+
+// the stress uses counted routes, the latency plain longs
+using table = l::list_type_from_size<route, 4>::type;
+using plain_table = l::list_type_from_size<long, 4>::type;
+
+template <typename T = table>
+static T make_table(long v)
+{ return T(v, v + 1, v + 2, v + 3); }
+
+template <typename T>
+static long check(const T& t) {
+    auto v = value(l::nth<0>(t));
+    if (value(l::nth<1>(t)) != v + 1 || value(l::nth<2>(t)) != v + 2 || value(l::nth<3>(t)) != v + 3) {
+        std::cerr << "inconsistent table" << std::endl;
+        std::abort();
+    }
+    return v;
+}
+
+// nothing is pinned anymore, two epochs are enough to delete everything
+static void check_reclaimed(const char* what) {
+    auto& d = l::epoch_domain_::instance();
+    for (int i = 0; i < 3; ++i) { d.reclaim(); }
+    if (d.pending() != 0 || route::live.load() != 0) {
+        std::cerr << what << " leak: " << d.pending() << " tables, "
+                  << route::live.load() << " routes" << std::endl;
+        std::abort();
+    }
+}
+
+static void moved_snapshot() {
+    {
+        l::atomic_list<table> shared(make_table(0));
+        auto s = shared.load();
+        std::thread([&s] {
+            auto moved = std::move(s);
+            check(*moved);
+        }).join();
+        // a pin left behind would keep these tables alive
+        for (long i = 1; i < 256; ++i) { shared.store(make_table(i)); }
+        check(*shared.load());
+    }
+    check_reclaimed("moved snapshot");
+}
+
+static void stress(std::size_t readers, std::size_t writers) {
+    std::atomic<bool> stop{false};
+    std::atomic<long> reads{0};
+    std::atomic<long> writes{0};
+    {
+        l::atomic_list<table> shared(make_table(0));
+        std::vector<std::thread> ts;
+        for (std::size_t i = 0; i < readers; ++i) {
+            ts.emplace_back([&] {
+                long n = 0;
+                long last = 0;
+                while (not stop.load(std::memory_order_relaxed)) {
+                    auto s = shared.load();
+                    auto v = check(*s);
+                    // a single writer publishes increasing versions
+                    if (writers == 1 && v < last) { std::abort(); }
+                    last = v;
+                    n += 1;
+                }
+                reads += n;
+            });
+        }
+        for (std::size_t i = 0; i < writers; ++i) {
+            ts.emplace_back([&, i] {
+                long n = 0;
+                while (not stop.load(std::memory_order_relaxed)) {
+                    if (i % 2 == 0) {
+                        shared.store(make_table(n * 4));
+                    } else {
+                        shared.update([](const table& t) { return make_table(value(l::hd(t)) + 4); });
+                    }
+                    n += 1;
+                }
+                writes += n;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        stop = true;
+        for (auto& t : ts) { t.join(); }
+    }
+    check_reclaimed("stress");
+    std::cout << "{\"suite\": \"atomic_list\", \"stress\": \"" << readers << " readers, "
+              << writers << " writers\", \"reads\": " << reads.load()
+              << ", \"writes\": " << writes.load() << "}" << std::endl;
+}
+
+// the way it was done before, the table is copied under the lock
+struct locked_list {
+    plain_table get() const {
+        std::lock_guard<std::mutex> g(m);
+        return t;
+    }
+    void set(plain_table n) {
+        std::lock_guard<std::mutex> g(m);
+        t = std::move(n);
+    }
+    mutable std::mutex m;
+    plain_table t = make_table<plain_table>(0);
+};
+
+template <typename Read, typename Write>
+static void latency(const char* impl, std::size_t readers, Read read, Write write) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> ts;
+    for (std::size_t i = 0; i < readers; ++i) {
+        ts.emplace_back([&] {
+            while (not stop.load(std::memory_order_relaxed)) { bench::do_not_optimize(read()); }
+        });
+    }
+    ts.emplace_back([&] {
+        long n = 0;
+        while (not stop.load(std::memory_order_relaxed)) {
+            write(n++);
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+    });
+    bench::run("atomic_list", impl, "read", readers + 1, [&] { bench::do_not_optimize(read()); });
+    stop = true;
+    for (auto& t : ts) { t.join(); }
+}
+
+int main() {
+    auto hw = std::max(4u, std::thread::hardware_concurrency());
+    moved_snapshot();
+    stress(hw - 1, 1);
+    stress(hw / 2, hw / 2);
+
+    for (std::size_t readers : {std::size_t{0}, std::size_t{1}, std::size_t{hw - 1}}) {
+        l::atomic_list<plain_table> a(make_table<plain_table>(0));
+        latency("atomic_list", readers,
+                [&] { return check(*a.load()); },
+                [&](long n) { a.store(make_table<plain_table>(n)); });
+        locked_list m;
+        latency("mutex", readers,
+                [&] { return check(m.get()); },
+                [&](long n) { m.set(make_table<plain_table>(n)); });
+    }
+}
@@ -0,0 +1,185 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_BENCH_H
+#define IMM_BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// hardware counters through perf_event_open on linux, -DIMM_BENCH_NO_PERF
+// to measure the time only.
+#if defined(__linux__) && !defined(IMM_BENCH_NO_PERF)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define IMM_BENCH_PERF 1
+#endif
+
+// tiny runtime benchmark helpers, every measure is printed as one json
+// object per line so the output can be diffed or loaded by a script.
+
+namespace bench {
+
+// keep the compiler from optimizing a value away
+template <typename T>
+inline void do_not_optimize(const T& v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+// instructions and cache misses of the calling thread, user space only.
+// not available when perf_event_open is refused (perf_event_paranoid,
+// containers, virtual machines without a pmu), the measures then only
+// hold the time.
+class perf_counters {
+public:
+    perf_counters() noexcept {
+#ifdef IMM_BENCH_PERF
+        fd_[0] = open_(PERF_COUNT_HW_INSTRUCTIONS, -1);
+        if (fd_[0] >= 0) { fd_[1] = open_(PERF_COUNT_HW_CACHE_MISSES, fd_[0]); }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters() {
+#ifdef IMM_BENCH_PERF
+        for (auto fd : fd_) { if (fd >= 0) { close(fd); } }
+#endif
+    }
+
+    bool available() const noexcept { return fd_[0] >= 0 && fd_[1] >= 0; }
+
+    void start() noexcept {
+#ifdef IMM_BENCH_PERF
+        if (not available()) { return; }
+        ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // counts since start(), zero when not available
+    void stop(std::uint64_t& instructions, std::uint64_t& cache_misses) noexcept {
+        instructions = 0;
+        cache_misses = 0;
+#ifdef IMM_BENCH_PERF
+        if (not available()) { return; }
+        ioctl(fd_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(fd_[0], &instructions, sizeof(instructions)) != sizeof(instructions)) { instructions = 0; }
+        if (read(fd_[1], &cache_misses, sizeof(cache_misses)) != sizeof(cache_misses)) { cache_misses = 0; }
+#endif
+    }
+
+    // shared by all the measures of the process
+    static perf_counters& instance() {
+        static perf_counters c;
+        return c;
+    }
+
+private:
+#ifdef IMM_BENCH_PERF
+    // the first counter leads the group, the second follows its state
+    static int open_(std::uint64_t config, int group) noexcept {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+    int fd_[2] = {-1, -1};
+};
+
+// one measure, per call of the measured function. the counters are
+// negative when not available.
+struct measure {
+    double ns_per_op;
+    double instructions;
+    double cache_misses;
+};
+
+// run f until at least min_ms milliseconds elapsed, the counters cover the
+// last batch only, the one the time is computed from.
+template <typename Fn>
+measure measure_op(Fn f, double min_ms = 50.) {
+    using clock = std::chrono::steady_clock;
+    auto& pc = perf_counters::instance();
+    std::size_t iters = 1;
+    for (;;) {
+        std::uint64_t instructions, cache_misses;
+        pc.start();
+        auto start = clock::now();
+        for (std::size_t i = 0; i < iters; ++i) { f(); }
+        std::chrono::duration<double, std::nano> d = clock::now() - start;
+        pc.stop(instructions, cache_misses);
+        if (d.count() >= min_ms * 1e6) {
+            auto n = static_cast<double>(iters);
+            if (not pc.available()) { return measure{d.count() / n, -1., -1.}; }
+            return measure{d.count() / n, instructions / n, cache_misses / n};
+        }
+        iters *= 2;
+    }
+}
+
+// run f until at least min_ms milliseconds elapsed, returns ns per call
+template <typename Fn>
+double measure_ns(Fn f, double min_ms = 50.)
+{ return measure_op(f, min_ms).ns_per_op; }
+
+inline void report(const char* suite,
+                   const char* impl,
+                   const char* op,
+                   std::size_t size,
+                   const measure& m) {
+    std::cout << "{\"suite\": \"" << suite
+              << "\", \"impl\": \"" << impl
+              << "\", \"op\": \"" << op
+              << "\", \"size\": " << size
+              << ", \"ns_per_op\": " << m.ns_per_op;
+    if (m.instructions >= 0) {
+        std::cout << ", \"instructions\": " << m.instructions
+                  << ", \"cache_misses\": " << m.cache_misses;
+    }
+    std::cout << "}" << std::endl;
+}
+
+inline void report(const char* suite,
+                   const char* impl,
+                   const char* op,
+                   std::size_t size,
+                   double ns_per_op)
+{ report(suite, impl, op, size, measure{ns_per_op, -1., -1.}); }
+
+template <typename Fn>
+void run(const char* suite, const char* impl, const char* op, std::size_t size, Fn f)
+{ report(suite, impl, op, size, measure_op(f)); }
+
+} // bench
+
+#endif // IMM_BENCH_H
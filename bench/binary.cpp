@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// write and load of a 100 MB table. loading only maps the file and checks
+// the header, verify also computes the checksum of the payload.
+//
+//   g++ -std=c++14 -O2 -I . bench/binary.cpp -o binary_bench && ./binary_bench [file]
+
+#include <binary.h>
+#include <bench/bench.h>
+#include <cstdio>
+
+constexpr std::size_t N = 100 * 1024 * 1024 / sizeof(int);
+static l::flat_list<int, N> table;
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "/tmp/imm_binary_bench.imml";
+    for (std::size_t i = 0; i < N; ++i) { table.data[i] = static_cast<int>(i); }
+
+    bench::run("binary", "flat_list", "write", N, [&] {
+        l::write_binary(path, table);
+    });
+    bench::run("binary", "mapped_list", "load", N, [&] {
+        auto m = l::load_list<int>(path);
+        bench::do_not_optimize(m.size());
+    });
+    bench::run("binary", "mapped_list", "load verify", N, [&] {
+        auto m = l::load_list<int>(path, true);
+        bench::do_not_optimize(m.size());
+    });
+    auto m = l::load_list<int>(path);
+    std::size_t i = 0;
+    bench::run("binary", "mapped_list", "nth", N, [&] {
+        bench::do_not_optimize(l::nth(m, i));
+        i = (i + 4099) % N;
+    });
+    std::remove(path.c_str());
+}
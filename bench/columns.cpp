@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// assoc lookups on interleaved keys and values (flat_list of tuples and
+// cons_ assoc list) against the key column of assoc_columns. values are
+// 56 bytes routes, the key looked up is the last one.
+//
+//   g++ -std=c++14 -O2 -I . bench/columns.cpp -o columns_bench && ./columns_bench
+
+#include <columns.h>
+#include <bench/bench.h>
+
+struct route {
+    long next_hop;
+    long metric[6];
+};
+
+using entry = std::tuple<int, route>;
+
+template <std::size_t N>
+int aos_pos(int a, const l::flat_list<entry, N>& l) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (std::get<0>(l.data[i]) == a) { return static_cast<int>(i); }
+    }
+    return -1;
+}
+
+template <std::size_t N>
+void bench_size() {
+    static l::flat_list<entry, N> aos;
+    for (std::size_t i = 0; i < N; ++i) {
+        aos.data[i] = entry(static_cast<int>(i * 7), route{static_cast<long>(i), {}});
+    }
+    static auto cols = l::split(aos);
+    int key = static_cast<int>((N - 1) * 7);
+    bench::do_not_optimize(key);
+
+    bench::run("columns", "flat tuples", "assoc", N, [&] {
+        auto i = aos_pos(key, aos);
+        bench::do_not_optimize(std::get<1>(aos.data[i]).next_hop);
+    });
+    bench::run("columns", "assoc_columns", "assoc", N, [&] {
+        bench::do_not_optimize(l::assoc(key, cols).next_hop);
+    });
+    bench::run("columns", "assoc_columns", "mem_assoc miss", N, [&] {
+        bench::do_not_optimize(l::mem_assoc(key + 1, cols));
+    });
+    bench::run("columns", "assoc_columns", "split", N, [&] {
+        bench::do_not_optimize(l::split(aos).keys.data[N - 1]);
+    });
+}
+
+int main() {
+    {
+        using al = l::list_type_from_size<entry, 16>::type;
+        static al c = l::to_cons(l::combine(
+            l::flat_list<int, 16>{{0, 7, 14, 21, 28, 35, 42, 49, 56, 63, 70, 77, 84, 91, 98, 105}},
+            l::flat_list<route, 16>{}));
+        static auto cols = l::to_columns(c);
+        int key = 105;
+        bench::do_not_optimize(key);
+        bench::run("columns", "cons_ tuples", "assoc", 16, [&] {
+            bench::do_not_optimize(l::assoc(key, c).next_hop);
+        });
+        bench::run("columns", "assoc_columns", "assoc", 16, [&] {
+            bench::do_not_optimize(l::assoc(key, cols).next_hop);
+        });
+    }
+    bench_size<64>();
+    bench_size<1024>();
+    bench_size<16384>();
+}
@@ -0,0 +1,105 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// building a list of N elements known at run time: nested cons calls
+// against make_list, from_array and generate. the number of element
+// copies made by each is printed first. see compile_bench.py --builders
+// for the compile time of larger lists.
+//
+//   g++ -std=c++14 -O2 -ftemplate-depth=4096 -I . bench/construct.cpp -o construct_bench && ./construct_bench
+
+#include <list.h>
+#include <bench/bench.h>
+#include <array>
+#include <utility>
+
+// element counting its copies and moves
+struct counted {
+    static long copies;
+    counted(int v = 0) : v(v) {}
+    counted(const counted& o) : v(o.v) { copies += 1; }
+    counted(counted&& o) noexcept : v(o.v) { copies += 1; }
+    counted& operator=(const counted&) = default;
+    int v;
+};
+long counted::copies = 0;
+
+template <typename T, std::size_t N>
+struct build_cons {
+    static auto run(const T* p) { return cons(p[0], build_cons<T, N - 1>::run(p + 1)); }
+};
+
+template <typename T>
+struct build_cons<T, 1> {
+    static auto run(const T* p) { return cons(p[0]); }
+};
+
+template <typename T, std::size_t... I>
+auto build_make_list(const T* p, std::index_sequence<I...>)
+{ return l::make_list(p[I]...); }
+
+template <typename Fn>
+void copies(const char* impl, std::size_t n, Fn f) {
+    counted::copies = 0;
+    bench::do_not_optimize(f());
+    std::cout << "{\"suite\": \"construct\", \"impl\": \"" << impl
+              << "\", \"op\": \"copies\", \"size\": " << n
+              << ", \"copies\": " << counted::copies << "}" << std::endl;
+}
+
+template <typename T, std::size_t N>
+void bench_impls(const char* op, const std::array<T, N>& src) {
+    bench::run("construct", "cons", op, N, [&] {
+        bench::do_not_optimize(build_cons<T, N>::run(src.data()));
+    });
+    bench::run("construct", "make_list", op, N, [&] {
+        bench::do_not_optimize(build_make_list(src.data(), std::make_index_sequence<N>{}));
+    });
+    bench::run("construct", "from_array", op, N, [&] {
+        bench::do_not_optimize(l::from_array(src));
+    });
+    bench::run("construct", "generate", op, N, [&] {
+        bench::do_not_optimize(l::generate<N>([&](std::size_t i) { return src[i]; }));
+    });
+}
+
+template <std::size_t N>
+void bench_size() {
+    std::array<counted, N> csrc;
+    for (std::size_t i = 0; i < N; ++i) { csrc[i] = counted(static_cast<int>(i)); }
+    copies("cons", N, [&] { return build_cons<counted, N>::run(csrc.data()); });
+    copies("make_list", N, [&] { return build_make_list(csrc.data(), std::make_index_sequence<N>{}); });
+    copies("from_array", N, [&] { return l::from_array(csrc); });
+
+    std::array<int, N> src;
+    for (std::size_t i = 0; i < N; ++i) { src[i] = static_cast<int>(i); }
+    bench_impls("build int", src);
+    // the nested cons of large elements need O(N^2) bytes of stack
+    static std::array<std::array<long, 8>, N> fat{};
+    if (N <= 256) { bench_impls("build 64 bytes", fat); }
+}
+
+int main() {
+    bench_size<16>();
+    bench_size<256>();
+    bench_size<512>();
+}
@@ -0,0 +1,108 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// unrolled dyn_list against std::list, std::forward_list and std::vector:
+// build from a vector, sum all the elements, index the middle element.
+// the arena uses 64KiB blocks, with the default 4KiB blocks the build of
+// the large lists is dominated by the allocation of the blocks.
+//
+//   g++ -std=c++14 -O2 -I . bench/dyn_list.cpp -o dyn_list_bench && ./dyn_list_bench
+
+#include <dyn_list.h>
+#include <bench/bench.h>
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <vector>
+
+void bench_size(std::size_t n) {
+    std::vector<int> src(n);
+    for (std::size_t i = 0; i < n; ++i) { src[i] = static_cast<int>(i); }
+
+    bench::run("dyn_list", "dyn_list", "build", n, [&] {
+        l::arena a(1 << 16);
+        auto l = l::make_dyn_list<int>(a, src.begin(), src.end());
+        bench::do_not_optimize(l);
+    });
+    bench::run("dyn_list", "std::list", "build", n, [&] {
+        std::list<int> l(src.begin(), src.end());
+        bench::do_not_optimize(l);
+    });
+    bench::run("dyn_list", "std::forward_list", "build", n, [&] {
+        std::forward_list<int> l(src.begin(), src.end());
+        bench::do_not_optimize(l);
+    });
+    bench::run("dyn_list", "std::vector", "build", n, [&] {
+        std::vector<int> v(src.begin(), src.end());
+        bench::do_not_optimize(v.data());
+    });
+
+    l::arena a;
+    auto d = l::make_dyn_list<int>(a, src.begin(), src.end());
+    std::list<int> sl(src.begin(), src.end());
+    std::forward_list<int> fl(src.begin(), src.end());
+    const auto& v = src;
+
+    bench::run("dyn_list", "dyn_list", "iter", n, [&] {
+        int s = 0;
+        l::iter([&](int e) { s += e; }, d);
+        bench::do_not_optimize(s);
+    });
+    bench::run("dyn_list", "std::list", "iter", n, [&] {
+        int s = 0;
+        for (auto e : sl) { s += e; }
+        bench::do_not_optimize(s);
+    });
+    bench::run("dyn_list", "std::forward_list", "iter", n, [&] {
+        int s = 0;
+        for (auto e : fl) { s += e; }
+        bench::do_not_optimize(s);
+    });
+    bench::run("dyn_list", "std::vector", "iter", n, [&] {
+        int s = 0;
+        for (auto e : v) { s += e; }
+        bench::do_not_optimize(s);
+    });
+
+    bench::run("dyn_list", "dyn_list", "nth", n, [&] {
+        auto e = l::nth(d, n / 2);
+        bench::do_not_optimize(e);
+    });
+    bench::run("dyn_list", "std::list", "nth", n, [&] {
+        auto e = *std::next(sl.begin(), static_cast<std::ptrdiff_t>(n / 2));
+        bench::do_not_optimize(e);
+    });
+    bench::run("dyn_list", "std::forward_list", "nth", n, [&] {
+        auto e = *std::next(fl.begin(), static_cast<std::ptrdiff_t>(n / 2));
+        bench::do_not_optimize(e);
+    });
+    bench::run("dyn_list", "std::vector", "nth", n, [&] {
+        auto e = v[n / 2];
+        bench::do_not_optimize(e);
+    });
+}
+
+int main() {
+    bench_size(64);
+    bench_size(4096);
+    bench_size(1 << 18);
+}
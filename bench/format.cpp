@@ -0,0 +1,68 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// rendering a list as text: operator<< into an ostringstream against
+// format_to into a reused buffer.
+//
+//   g++ -std=c++14 -O2 -I . bench/format.cpp -o format_bench && ./format_bench
+
+#include <format.h>
+#include <bench/bench.h>
+#include <sstream>
+
+template <typename L>
+void bench_list(const char* op, std::size_t n, const L& l) {
+    bench::run("format", "operator<<", op, n, [&] {
+        std::ostringstream os;
+        os << l;
+        bench::do_not_optimize(os.str().size());
+    });
+    static char buf[1 << 16];
+    bench::run("format", "format_to", op, n, [&] {
+        bench::do_not_optimize(l::format_to(buf, sizeof(buf), l));
+    });
+}
+
+template <typename T, std::size_t N>
+void bench_size(const char* op, T scale) {
+    static l::flat_list<T, N> fl;
+    for (std::size_t i = 0; i < N; ++i) { fl.data[i] = static_cast<T>(i * 7919) * scale; }
+    bench_list(op, N, fl);
+}
+
+template <std::size_t... I>
+auto make_cons_(std::index_sequence<I...>)
+    -> typename l::list_type_from_size<int, sizeof...(I)>::type
+{ return typename l::list_type_from_size<int, sizeof...(I)>::type(static_cast<int>(I * 7919)...); }
+
+int main() {
+    bench_size<int, 16>("int", 1);
+    bench_size<int, 1024>("int", 1);
+    bench_size<long long, 1024>("long long", -1000003);
+    bench_size<double, 1024>("double", 0.25);
+    bench_list("cons_ int", 64, make_cons_(std::make_index_sequence<64>{}));
+    auto e = cons(std::make_tuple(1, 2.5), cons(std::make_tuple(2, 5.), cons(std::make_tuple(3, 7.5))));
+    static char buf[256];
+    bench::run("format", "format_to", "assoc", 3, [&] {
+        bench::do_not_optimize(l::format_to(buf, sizeof(buf), e));
+    });
+}
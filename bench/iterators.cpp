@@ -0,0 +1,101 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// standard algorithms on a homogeneous cons_ list through l::begin/l::end
+// against the recursive algorithms of the library: accumulate against
+// fold_left and reduce, lower_bound against find, and sort of a copy of
+// the list in place. the list is also checked as a contiguous range when
+// compiled as c++20, and reduced with std::execution::par as c++17.
+//
+//   g++ -std=c++14 -O2 -I . bench/iterators.cpp -o iterators_bench && ./iterators_bench
+//   g++ -std=c++20 -O2 -I . bench/iterators.cpp -o iterators_bench -ltbb && ./iterators_bench
+
+#include <list.h>
+#include <bench/bench.h>
+#include <algorithm>
+#include <numeric>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#define IMM_BENCH_EXECUTION 1
+#endif
+#endif
+
+#if __cplusplus >= 202002L
+#include <ranges>
+using ranges_list = l::list_type_from_size<int, 8>::type;
+static_assert(std::ranges::random_access_range<ranges_list>, "cons_ list is not a random access range");
+static_assert(std::ranges::contiguous_range<const ranges_list>, "cons_ list is not a contiguous range");
+static_assert(std::ranges::sized_range<ranges_list>, "cons_ list is not a sized range");
+#endif
+
+struct value_of {
+    long operator()(std::size_t i) const { return static_cast<long>(i * 7 % 1000); }
+};
+
+struct sorted_of {
+    long operator()(std::size_t i) const { return static_cast<long>(i * 3); }
+};
+
+template <std::size_t N>
+void bench_size() {
+    static const auto a = l::generate<N>(value_of{});
+    static const auto s = l::generate<N>(sorted_of{});
+    long key = static_cast<long>((N / 3) * 3);
+    bench::do_not_optimize(key);
+
+    bench::run("iterators", "std::accumulate", "sum", N, [&] {
+        bench::do_not_optimize(std::accumulate(l::begin(a), l::end(a), 0L));
+    });
+    bench::run("iterators", "fold_left", "sum", N, [&] {
+        bench::do_not_optimize(l::fold_left(std::plus<>{}, 0L, a));
+    });
+    bench::run("iterators", "reduce", "sum", N, [&] {
+        bench::do_not_optimize(l::reduce(std::plus<>{}, a));
+    });
+#ifdef IMM_BENCH_EXECUTION
+    bench::run("iterators", "std::reduce par", "sum", N, [&] {
+        bench::do_not_optimize(std::reduce(std::execution::par, l::begin(a), l::end(a), 0L));
+    });
+#endif
+
+    bench::run("iterators", "std::lower_bound", "search", N, [&] {
+        bench::do_not_optimize(*std::lower_bound(l::begin(s), l::end(s), key));
+    });
+    bench::run("iterators", "find", "search", N, [&] {
+        bench::do_not_optimize(l::find([&](long e) { return e >= key; }, s));
+    });
+
+    static auto c = a;
+    bench::run("iterators", "std::sort", "copy and sort", N, [&] {
+        c = a;
+        std::sort(l::begin(c), l::end(c));
+        bench::do_not_optimize(c);
+    });
+}
+
+int main() {
+    bench_size<16>();
+    bench_size<64>();
+    bench_size<256>();
+}
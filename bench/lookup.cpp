@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// hit and miss latency of the throwing lookups (find, assoc) against the
+// pointer returning ones (find_opt, assoc_opt), and runtime indexing of a
+// cons_ list with at against a walk of the list.
+//
+//   g++ -std=c++14 -O2 -I . bench/lookup.cpp -o lookup_bench && ./lookup_bench
+
+#include <list.h>
+#include <bench/bench.h>
+#include <tuple>
+
+template <std::size_t N>
+struct key_of {
+    int operator()(std::size_t i) const { return static_cast<int>(i * 3); }
+};
+
+template <std::size_t N>
+struct entry_of {
+    std::tuple<int, long> operator()(std::size_t i) const
+    { return std::make_tuple(static_cast<int>(i * 3), static_cast<long>(i)); }
+};
+
+template <std::size_t N>
+void bench_size() {
+    static const auto keys = l::generate<N>(key_of<N>{});
+    static const auto entries = l::generate<N>(entry_of<N>{});
+    int hit = static_cast<int>((N - 1) * 3);
+    int miss = 1;
+    bench::do_not_optimize(hit);
+    bench::do_not_optimize(miss);
+
+    bench::run("lookup", "find", "hit", N, [&] {
+        bench::do_not_optimize(l::find([&](int e) { return e == hit; }, keys));
+    });
+    bench::run("lookup", "find", "miss", N, [&] {
+        try {
+            bench::do_not_optimize(l::find([&](int e) { return e == miss; }, keys));
+        } catch (const l::not_found&) {}
+    });
+    bench::run("lookup", "find_opt", "hit", N, [&] {
+        bench::do_not_optimize(*l::find_opt([&](int e) { return e == hit; }, keys));
+    });
+    bench::run("lookup", "find_opt", "miss", N, [&] {
+        bench::do_not_optimize(l::find_opt([&](int e) { return e == miss; }, keys));
+    });
+
+    bench::run("lookup", "assoc", "hit", N, [&] {
+        bench::do_not_optimize(l::assoc(hit, entries));
+    });
+    bench::run("lookup", "assoc", "miss", N, [&] {
+        try {
+            bench::do_not_optimize(l::assoc(miss, entries));
+        } catch (const l::not_found&) {}
+    });
+    bench::run("lookup", "assoc_opt", "hit", N, [&] {
+        bench::do_not_optimize(*l::assoc_opt(hit, entries));
+    });
+    bench::run("lookup", "assoc_opt", "miss", N, [&] {
+        bench::do_not_optimize(l::assoc_opt(miss, entries));
+    });
+
+    std::size_t i = 0;
+    bench::run("lookup", "at", "runtime index", N, [&] {
+        i = (i + 7) % N;
+        bench::do_not_optimize(l::at(keys, i));
+    });
+    bench::run("lookup", "walk", "runtime index", N, [&] {
+        i = (i + 7) % N;
+        bench::do_not_optimize(l::at_walk_(keys, i));
+    });
+}
+
+int main() {
+    bench_size<8>();
+    bench_size<64>();
+    bench_size<256>();
+}
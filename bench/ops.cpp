@@ -0,0 +1,354 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// the list operations against the standard containers holding the same
+// elements: std::array, std::tuple, std::vector and std::list. each
+// operation is measured for several sizes and element types, with the
+// instructions and cache misses per call when the perf counters can be
+// read. run it through runtime_bench.py to get a json file which can be
+// compared with the one of another commit.
+//
+//   g++ -std=c++14 -O2 -I . bench/ops.cpp -o ops_bench && ./ops_bench
+
+#include <list.h>
+#include <bench/bench.h>
+#include <algorithm>
+#include <array>
+#include <list>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+template <typename T>
+struct value_of {
+    T operator()(std::size_t i) const { return static_cast<T>(i * 7 % 1000); }
+};
+
+template <typename T>
+struct entry_of {
+    std::tuple<int, T> operator()(std::size_t i) const
+    { return std::make_tuple(static_cast<int>(i * 7 % 1000), value_of<T>{}(i)); }
+};
+
+// std::tuple helpers, one expression per element
+
+template <typename T, std::size_t... I>
+auto tuple_of_(std::index_sequence<I...>)
+{ return std::make_tuple(value_of<T>{}(I)...); }
+
+template <typename T, typename Tu, std::size_t... I>
+T tuple_sum_(const Tu& t, std::index_sequence<I...>) {
+    T s{};
+    int _[] = {(s += std::get<I>(t), 0)...};
+    (void)_;
+    return s;
+}
+
+template <typename Tu, std::size_t... I>
+auto tuple_map_(const Tu& t, std::index_sequence<I...>)
+{ return std::make_tuple((std::get<I>(t) + 1)...); }
+
+template <typename Tu, std::size_t... I>
+auto tuple_rev_(const Tu& t, std::index_sequence<I...>)
+{ return std::make_tuple(std::get<sizeof...(I) - 1 - I>(t)...); }
+
+template <typename T, typename Tu, std::size_t... I>
+bool tuple_mem_(const T& v, const Tu& t, std::index_sequence<I...>) {
+    bool r = false;
+    int _[] = {(r = r || std::get<I>(t) == v, 0)...};
+    (void)_;
+    return r;
+}
+
+template <typename Tu, std::size_t... I>
+void tuple_print_(std::ostream& os, const Tu& t, std::index_sequence<I...>) {
+    os << "[";
+    int _[] = {(os << (I == 0 ? "" : ", ") << std::get<I>(t), 0)...};
+    (void)_;
+    os << "]";
+}
+
+template <typename C>
+void print_(std::ostream& os, const C& c) {
+    os << "[";
+    bool first = true;
+    for (const auto& e : c) {
+        os << (first ? "" : ", ") << e;
+        first = false;
+    }
+    os << "]";
+}
+
+// "name type", valid until the next call
+inline const char* op_(const char* name, const char* type) {
+    static std::string s;
+    s = std::string(name) + " " + type;
+    return s.c_str();
+}
+
+template <typename T, std::size_t N>
+void bench_ops(const char* type) {
+    auto op = [&](const char* name) { return op_(name, type); };
+    static const auto a = l::generate<N>(value_of<T>{});
+    static const auto arr = [] {
+        std::array<T, N> r{};
+        for (std::size_t i = 0; i < N; ++i) { r[i] = value_of<T>{}(i); }
+        return r;
+    }();
+    static const std::vector<T> vec(arr.begin(), arr.end());
+    static const std::list<T> lst(arr.begin(), arr.end());
+    static const auto ea = l::generate<N>(entry_of<T>{});
+    static const auto evec = [] {
+        std::vector<std::pair<int, T>> r;
+        for (std::size_t i = 0; i < N; ++i) { r.emplace_back(std::get<0>(entry_of<T>{}(i)), value_of<T>{}(i)); }
+        return r;
+    }();
+    static const std::list<std::pair<int, T>> elst(evec.begin(), evec.end());
+
+    const T last = value_of<T>{}(N - 1);
+    const T miss = static_cast<T>(-1);
+    const int key = std::get<0>(entry_of<T>{}(N - 1));
+    auto by_key = [&](const std::pair<int, T>& e) { return e.first == key; };
+    std::ostringstream os;
+
+
+    // nth, the last element
+
+    bench::run("ops", "cons_", op("nth"), N, [&] {
+        bench::do_not_optimize(l::nth<N - 1>(a));
+    });
+    bench::run("ops", "std::array", op("nth"), N, [&] {
+        bench::do_not_optimize(std::get<N - 1>(arr));
+    });
+    bench::run("ops", "std::vector", op("nth"), N, [&] {
+        bench::do_not_optimize(vec[N - 1]);
+    });
+    bench::run("ops", "std::list", op("nth"), N, [&] {
+        bench::do_not_optimize(*std::next(lst.begin(), N - 1));
+    });
+
+    // iter, sum of the elements
+
+    bench::run("ops", "cons_", op("iter"), N, [&] {
+        T s{};
+        l::iter([&](T e) { s += e; }, a);
+        bench::do_not_optimize(s);
+    });
+    bench::run("ops", "std::array", op("iter"), N, [&] {
+        T s{};
+        for (auto e : arr) { s += e; }
+        bench::do_not_optimize(s);
+    });
+    bench::run("ops", "std::vector", op("iter"), N, [&] {
+        T s{};
+        for (auto e : vec) { s += e; }
+        bench::do_not_optimize(s);
+    });
+    bench::run("ops", "std::list", op("iter"), N, [&] {
+        T s{};
+        for (auto e : lst) { s += e; }
+        bench::do_not_optimize(s);
+    });
+
+    // map, a new container of e + 1
+
+    bench::run("ops", "cons_", op("map"), N, [&] {
+        auto r = l::map([](T e) { return e + 1; }, a);
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::array", op("map"), N, [&] {
+        std::array<T, N> r;
+        std::transform(arr.begin(), arr.end(), r.begin(), [](T e) { return e + 1; });
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::vector", op("map"), N, [&] {
+        std::vector<T> r(vec.size());
+        std::transform(vec.begin(), vec.end(), r.begin(), [](T e) { return e + 1; });
+        bench::do_not_optimize(r.data());
+    });
+    bench::run("ops", "std::list", op("map"), N, [&] {
+        std::list<T> r;
+        std::transform(lst.begin(), lst.end(), std::back_inserter(r), [](T e) { return e + 1; });
+        bench::do_not_optimize(r.back());
+    });
+
+    // rev, a new reversed container
+
+    bench::run("ops", "cons_", op("rev"), N, [&] {
+        auto r = l::rev(a);
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::array", op("rev"), N, [&] {
+        std::array<T, N> r;
+        std::reverse_copy(arr.begin(), arr.end(), r.begin());
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::vector", op("rev"), N, [&] {
+        std::vector<T> r(vec.rbegin(), vec.rend());
+        bench::do_not_optimize(r.data());
+    });
+    bench::run("ops", "std::list", op("rev"), N, [&] {
+        std::list<T> r(lst.rbegin(), lst.rend());
+        bench::do_not_optimize(r.back());
+    });
+
+    // append, a new container holding the elements twice
+
+    bench::run("ops", "cons_", op("append"), N, [&] {
+        auto r = l::append(a, a);
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::array", op("append"), N, [&] {
+        std::array<T, 2 * N> r;
+        std::copy(arr.begin(), arr.end(), std::copy(arr.begin(), arr.end(), r.begin()));
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::vector", op("append"), N, [&] {
+        std::vector<T> r;
+        r.reserve(2 * N);
+        r.insert(r.end(), vec.begin(), vec.end());
+        r.insert(r.end(), vec.begin(), vec.end());
+        bench::do_not_optimize(r.data());
+    });
+    bench::run("ops", "std::list", op("append"), N, [&] {
+        std::list<T> r(lst);
+        r.insert(r.end(), lst.begin(), lst.end());
+        bench::do_not_optimize(r.back());
+    });
+
+    // mem, an element which is not there
+
+    bench::run("ops", "cons_", op("mem"), N, [&] {
+        bench::do_not_optimize(l::mem(miss, a));
+    });
+    bench::run("ops", "std::array", op("mem"), N, [&] {
+        bench::do_not_optimize(std::find(arr.begin(), arr.end(), miss) != arr.end());
+    });
+    bench::run("ops", "std::vector", op("mem"), N, [&] {
+        bench::do_not_optimize(std::find(vec.begin(), vec.end(), miss) != vec.end());
+    });
+    bench::run("ops", "std::list", op("mem"), N, [&] {
+        bench::do_not_optimize(std::find(lst.begin(), lst.end(), miss) != lst.end());
+    });
+
+    // find, the last element
+
+    bench::run("ops", "cons_", op("find"), N, [&] {
+        bench::do_not_optimize(l::find([&](T e) { return e == last; }, a));
+    });
+    bench::run("ops", "std::array", op("find"), N, [&] {
+        bench::do_not_optimize(*std::find_if(arr.begin(), arr.end(), [&](T e) { return e == last; }));
+    });
+    bench::run("ops", "std::vector", op("find"), N, [&] {
+        bench::do_not_optimize(*std::find_if(vec.begin(), vec.end(), [&](T e) { return e == last; }));
+    });
+    bench::run("ops", "std::list", op("find"), N, [&] {
+        bench::do_not_optimize(*std::find_if(lst.begin(), lst.end(), [&](T e) { return e == last; }));
+    });
+
+    // assoc, the value of the last key
+
+    bench::run("ops", "cons_", op("assoc"), N, [&] {
+        bench::do_not_optimize(l::assoc(key, ea));
+    });
+    bench::run("ops", "std::vector", op("assoc"), N, [&] {
+        bench::do_not_optimize(std::find_if(evec.begin(), evec.end(), by_key)->second);
+    });
+    bench::run("ops", "std::list", op("assoc"), N, [&] {
+        bench::do_not_optimize(std::find_if(elst.begin(), elst.end(), by_key)->second);
+    });
+
+    // operator<<, "[e0, e1, ...]" to a string stream
+
+    bench::run("ops", "cons_", op("operator<<"), N, [&] {
+        os.str("");
+        os << a;
+        bench::do_not_optimize(os);
+    });
+    bench::run("ops", "std::array", op("operator<<"), N, [&] {
+        os.str("");
+        print_(os, arr);
+        bench::do_not_optimize(os);
+    });
+    bench::run("ops", "std::vector", op("operator<<"), N, [&] {
+        os.str("");
+        print_(os, vec);
+        bench::do_not_optimize(os);
+    });
+    bench::run("ops", "std::list", op("operator<<"), N, [&] {
+        os.str("");
+        print_(os, lst);
+        bench::do_not_optimize(os);
+    });
+}
+
+// std::tuple, only for the small sizes: a tuple of hundreds of elements
+// exceeds the default template depth and takes minutes to compile.
+template <typename T, std::size_t N>
+void bench_tuple(const char* type) {
+    using is = std::make_index_sequence<N>;
+    static const auto t = tuple_of_<T>(is{});
+    const T miss = static_cast<T>(-1);
+    std::ostringstream os;
+    auto op = [&](const char* name) { return op_(name, type); };
+
+    bench::run("ops", "std::tuple", op("nth"), N, [&] {
+        bench::do_not_optimize(std::get<N - 1>(t));
+    });
+    bench::run("ops", "std::tuple", op("iter"), N, [&] {
+        bench::do_not_optimize(tuple_sum_<T>(t, is{}));
+    });
+    bench::run("ops", "std::tuple", op("map"), N, [&] {
+        auto r = tuple_map_(t, is{});
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::tuple", op("rev"), N, [&] {
+        auto r = tuple_rev_(t, is{});
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::tuple", op("append"), N, [&] {
+        auto r = std::tuple_cat(t, t);
+        bench::do_not_optimize(r);
+    });
+    bench::run("ops", "std::tuple", op("mem"), N, [&] {
+        bench::do_not_optimize(tuple_mem_(miss, t, is{}));
+    });
+    bench::run("ops", "std::tuple", op("operator<<"), N, [&] {
+        os.str("");
+        tuple_print_(os, t, is{});
+        bench::do_not_optimize(os);
+    });
+}
+
+int main() {
+    bench_ops<int, 8>("int");
+    bench_ops<int, 64>("int");
+    bench_ops<int, 256>("int");
+    bench_ops<double, 8>("double");
+    bench_ops<double, 64>("double");
+    bench_ops<double, 256>("double");
+    bench_tuple<int, 8>("int");
+    bench_tuple<int, 64>("int");
+    bench_tuple<double, 8>("double");
+    bench_tuple<double, 64>("double");
+}
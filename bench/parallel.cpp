@@ -0,0 +1,56 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// scaling of the parallel map with the number of threads, f is a costly
+// per element transform.
+//
+//   g++ -std=c++14 -O2 -pthread -I . bench/parallel.cpp -o parallel_bench && ./parallel_bench
+
+#include <parallel.h>
+#include <bench/bench.h>
+#include <cmath>
+#include <string>
+
+static double costly(double e) {
+    for (int i = 0; i < 200; ++i) { e = std::sqrt(e + i); }
+    return e;
+}
+
+int main() {
+    constexpr std::size_t N = 4096;
+    static l::flat_list<double, N> l;
+    for (std::size_t i = 0; i < N; ++i) { l.data[i] = static_cast<double>(i); }
+
+    bench::run("parallel", "sequential", "map", N, [&] {
+        bench::do_not_optimize(l::map(l::seq, costly, l));
+    });
+
+    auto max_threads = std::max(4u, std::thread::hardware_concurrency());
+    for (std::size_t t = 1; t <= max_threads; t *= 2) {
+        l::thread_pool pool(t);
+        auto impl = std::to_string(t) + " threads";
+        bench::run("parallel", impl.c_str(), "map", N, [&] {
+            bench::do_not_optimize(l::map(l::par(pool), costly, l));
+        });
+    }
+}
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// persistent list against cons_ and std::vector:
+// build by prepending N elements, then sum them.
+//
+//   g++ -std=c++14 -O2 -I . bench/plist.cpp -o plist_bench && ./plist_bench
+
+#include <list.h>
+#include <plist.h>
+#include <bench/bench.h>
+#include <vector>
+
+template <std::size_t N>
+struct build_cons {
+    static auto run(int i) { return cons(i, build_cons<N - 1>::run(i + 1)); }
+};
+
+template <>
+struct build_cons<1> {
+    static auto run(int i) { return cons(i); }
+};
+
+template <std::size_t N>
+void bench_size() {
+    bench::run("plist", "cons_", "build", N, [] {
+        auto l = build_cons<N>::run(0);
+        bench::do_not_optimize(l);
+    });
+    bench::run("plist", "plist", "build", N, [] {
+        l::arena a;
+        auto l = l::plist<int>(a);
+        for (std::size_t i = 0; i < N; ++i) { l = cons(static_cast<int>(i), l); }
+        bench::do_not_optimize(l);
+    });
+    bench::run("plist", "std::vector", "build", N, [] {
+        std::vector<int> v;
+        for (std::size_t i = 0; i < N; ++i) { v.push_back(static_cast<int>(i)); }
+        bench::do_not_optimize(v.data());
+    });
+
+    auto c = build_cons<N>::run(0);
+    l::arena a;
+    auto p = l::plist<int>(a);
+    for (std::size_t i = 0; i < N; ++i) { p = cons(static_cast<int>(i), p); }
+    std::vector<int> v(N, 1);
+
+    bench::run("plist", "cons_", "iter", N, [&] {
+        int s = 0;
+        l::iter([&](int e) { s += e; }, c);
+        bench::do_not_optimize(s);
+    });
+    bench::run("plist", "plist", "iter", N, [&] {
+        int s = 0;
+        l::iter([&](int e) { s += e; }, p);
+        bench::do_not_optimize(s);
+    });
+    bench::run("plist", "std::vector", "iter", N, [&] {
+        int s = 0;
+        for (auto e : v) { s += e; }
+        bench::do_not_optimize(s);
+    });
+
+    bench::run("plist", "cons_", "tl", N, [&] {
+        auto t = l::tl(c);
+        bench::do_not_optimize(t);
+    });
+    bench::run("plist", "plist", "tl", N, [&] {
+        auto t = l::tl(p);
+        bench::do_not_optimize(t);
+    });
+}
+
+int main() {
+    bench_size<16>();
+    bench_size<64>();
+    bench_size<256>();
+}
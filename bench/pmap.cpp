@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// persistent hash map against std::unordered_map and a copy on write
+// unordered_map (the map is shared until written, a write copies it).
+// lookups of present and absent keys, persistent add and remove of one
+// key keeping the old version, and building a map of N keys at once or by
+// successive adds.
+//
+//   g++ -std=c++14 -O2 -I . bench/pmap.cpp -o pmap_bench && ./pmap_bench
+
+#include <pmap.h>
+#include <bench/bench.h>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using cow_map = std::shared_ptr<const std::unordered_map<int, int>>;
+
+void bench_size(std::size_t n) {
+    std::mt19937 g(42);
+    std::vector<int> keys(n);
+    std::vector<int> absent(n);
+    std::vector<std::pair<int, int>> entries(n);
+    std::unordered_map<int, int> u;
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(g());
+        entries[i] = std::make_pair(keys[i], keys[i]);
+        u[keys[i]] = keys[i];
+    }
+    for (auto& k : absent) {
+        do { k = static_cast<int>(g()); } while (u.count(k) != 0);
+    }
+
+    l::arena a;
+    auto p = l::make_pmap<int, int>(a, entries.begin(), entries.end());
+    cow_map c = std::make_shared<const std::unordered_map<int, int>>(u);
+
+    std::size_t i = 0;
+    auto next = [&](const std::vector<int>& ks) { i = i + 1 == n ? 0 : i + 1; return ks[i]; };
+
+    bench::run("pmap", "pmap", "assoc_hit", n, [&] {
+        bench::do_not_optimize(l::assoc_opt(next(keys), p));
+    });
+    bench::run("pmap", "std::unordered_map", "assoc_hit", n, [&] {
+        bench::do_not_optimize(u.find(next(keys)));
+    });
+    bench::run("pmap", "pmap", "assoc_miss", n, [&] {
+        bench::do_not_optimize(l::assoc_opt(next(absent), p));
+    });
+    bench::run("pmap", "std::unordered_map", "assoc_miss", n, [&] {
+        bench::do_not_optimize(u.find(next(absent)));
+    });
+
+    // the new versions are allocated in a scratch arena, cleared from time
+    // to time, the nodes of p are shared.
+    l::arena scratch(1 << 16);
+    std::size_t live = 0;
+    auto shared = [&] {
+        if (++live == 4096) { scratch.clear(); live = 0; }
+        return l::pmap<int, int>(p.n, p.size(), &scratch);
+    };
+    bench::run("pmap", "pmap", "add", n, [&] {
+        auto k = next(absent);
+        bench::do_not_optimize(l::add(k, k, shared()));
+    });
+    bench::run("pmap", "cow_map", "add", n, [&] {
+        auto k = next(absent);
+        auto w = std::make_shared<std::unordered_map<int, int>>(*c);
+        (*w)[k] = k;
+        cow_map r = std::move(w);
+        bench::do_not_optimize(r);
+    });
+    // not persistent, the key is removed again to keep the size
+    bench::run("pmap", "std::unordered_map", "add", n, [&] {
+        auto k = next(absent);
+        u[k] = k;
+        u.erase(k);
+    });
+    bench::run("pmap", "pmap", "remove", n, [&] {
+        bench::do_not_optimize(l::remove(next(keys), shared()));
+    });
+    bench::run("pmap", "cow_map", "remove", n, [&] {
+        auto w = std::make_shared<std::unordered_map<int, int>>(*c);
+        w->erase(next(keys));
+        cow_map r = std::move(w);
+        bench::do_not_optimize(r);
+    });
+
+    bench::run("pmap", "pmap", "build", n, [&] {
+        l::arena b;
+        auto m = l::make_pmap<int, int>(b, entries.begin(), entries.end());
+        bench::do_not_optimize(m);
+    });
+    bench::run("pmap", "pmap", "build_add", n, [&] {
+        l::arena b;
+        l::pmap<int, int> m(b);
+        for (auto k : keys) { m = l::add(k, k, m); }
+        bench::do_not_optimize(m);
+    });
+    bench::run("pmap", "std::unordered_map", "build", n, [&] {
+        std::unordered_map<int, int> m;
+        for (auto k : keys) { m[k] = k; }
+        bench::do_not_optimize(m);
+    });
+}
+
+int main() {
+    bench_size(1000);
+    bench_size(100000);
+    bench_size(1000000);
+}
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// linear fold_left against the tree shaped reduce, and the parallel reduce
+// for the largest lists. the operations are associative: sum, min/max and
+// a polynomial hash where combine(a, b) = a * B^len(b) + b.
+//
+//   g++ -std=c++14 -O2 -pthread -I . bench/reduce.cpp -o reduce_bench && ./reduce_bench
+
+#include <parallel.h>
+#include <bench/bench.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+struct hash_ {
+    std::uint64_t h;
+    std::uint64_t pow;
+};
+
+struct combine_ {
+    hash_ operator()(const hash_& a, const hash_& b) const noexcept
+    { return hash_{a.h * b.pow + b.h, a.pow * b.pow}; }
+};
+
+struct min_max_ {
+    double min;
+    double max;
+};
+
+struct merge_ {
+    min_max_ operator()(const min_max_& a, const min_max_& b) const noexcept
+    { return min_max_{std::min(a.min, b.min), std::max(a.max, b.max)}; }
+};
+
+// init is the identity of f
+template <typename L, typename Fn, typename T>
+void bench_op(const char* op, std::size_t n, const L& l, Fn f, T init) {
+    bench::run("reduce", "fold_left", op, n, [&] {
+        bench::do_not_optimize(l::fold_left(f, init, l));
+    });
+    bench::run("reduce", "tree", op, n, [&] {
+        bench::do_not_optimize(l::reduce(f, l));
+    });
+}
+
+template <typename L, typename Fn>
+void bench_par(const char* op, std::size_t n, const L& l, Fn f, l::thread_pool& pool) {
+    bench::run("reduce", "parallel", op, n, [&] {
+        bench::do_not_optimize(l::reduce(l::par(pool), f, l));
+    });
+}
+
+template <std::size_t N>
+void bench_size(l::thread_pool& pool) {
+    static l::flat_list<std::int64_t, N> ints;
+    static l::flat_list<double, N> doubles;
+    static l::flat_list<min_max_, N> ranges;
+    static l::flat_list<hash_, N> hashes;
+    for (std::size_t i = 0; i < N; ++i) {
+        ints.data[i] = static_cast<std::int64_t>(i * 7 % 1000);
+        doubles.data[i] = static_cast<double>(i * 7 % 1000) * 0.5;
+        ranges.data[i] = min_max_{doubles.data[i], doubles.data[i]};
+        hashes.data[i] = hash_{i * 2654435761u, 31};
+    }
+
+    auto add_int = [](std::int64_t a, std::int64_t b) { return a + b; };
+    auto add_double = [](double a, double b) { return a + b; };
+    auto inf = std::numeric_limits<double>::infinity();
+    bench_op("sum int64", N, ints, add_int, std::int64_t{0});
+    bench_op("sum double", N, doubles, add_double, 0.);
+    bench_op("min/max", N, ranges, merge_{}, min_max_{inf, -inf});
+    bench_op("hash combine", N, hashes, combine_{}, hash_{0, 1});
+    if (N >= 4096) {
+        bench_par("sum double", N, doubles, add_double, pool);
+        bench_par("hash combine", N, hashes, combine_{}, pool);
+    }
+}
+
+// a cons_ list of 64 doubles, reduced at run time
+template <std::size_t... I>
+auto make_cons_(std::index_sequence<I...>)
+    -> typename l::list_type_from_size<double, sizeof...(I)>::type
+{ return typename l::list_type_from_size<double, sizeof...(I)>::type(static_cast<double>(I)...); }
+
+int main() {
+    l::thread_pool pool;
+    bench_size<16>(pool);
+    bench_size<256>(pool);
+    bench_size<4096>(pool);
+    bench_size<65536>(pool);
+
+    auto c = make_cons_(std::make_index_sequence<64>{});
+    bench_op("sum double cons_", 64, c, [](double a, double b) { return a + b; }, 0.);
+}
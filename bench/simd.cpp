@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// vectorized exists/for_all/mem on flat_list against the scalar loop, the
+// searched value is absent so the whole list is scanned.
+//
+//   g++ -std=c++14 -O2 -I . bench/simd.cpp -o simd_bench && ./simd_bench
+//   g++ -std=c++14 -O2 -mavx2 -I . bench/simd.cpp -o simd_bench && ./simd_bench
+
+#include <flat_list.h>
+#include <bench/bench.h>
+#include <string>
+
+template <typename T, std::size_t N>
+void bench_size(const char* type) {
+    static l::flat_list<T, N> l;
+    for (std::size_t i = 0; i < N; ++i) { l.data[i] = static_cast<T>(i % 100); }
+    T v = static_cast<T>(1000);
+    bench::do_not_optimize(v);
+
+    std::string scalar = std::string("scalar ") + type;
+    std::string simd = std::string("simd ") + type;
+    bench::run("simd", scalar.c_str(), "exists", N, [&] {
+        bench::do_not_optimize(l::exists([&](T e) { return e > v; }, l));
+    });
+    bench::run("simd", simd.c_str(), "exists", N, [&] {
+        bench::do_not_optimize(l::exists(l::gt(v), l));
+    });
+    bench::run("simd", scalar.c_str(), "for_all", N, [&] {
+        bench::do_not_optimize(l::for_all([&](T e) { return e < v; }, l));
+    });
+    bench::run("simd", simd.c_str(), "for_all", N, [&] {
+        bench::do_not_optimize(l::for_all(l::lt(v), l));
+    });
+    bench::run("simd", scalar.c_str(), "mem", N, [&] {
+        bench::do_not_optimize(l::exists([&](T e) { return e == v; }, l));
+    });
+    bench::run("simd", simd.c_str(), "mem", N, [&] {
+        bench::do_not_optimize(l::mem(v, l));
+    });
+}
+
+template <typename T>
+void bench_type(const char* type) {
+    bench_size<T, 16>(type);
+    bench_size<T, 64>(type);
+    bench_size<T, 256>(type);
+    bench_size<T, 1024>(type);
+    bench_size<T, 4096>(type);
+}
+
+int main() {
+    bench_type<int>("int");
+    bench_type<float>("float");
+    bench_type<double>("double");
+}
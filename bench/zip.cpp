@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// one fused pass over three lists with zip_with / zip_iter / zip_all
+// against what had to be written without them: iteri over the first list
+// with an indexed access into the others (at on a cons_ list, data[i] on a
+// flat_list), or for the cons_ lists of the smallest size an iter nested
+// in an iter.
+//
+//   g++ -std=c++14 -O2 -I . bench/zip.cpp -o zip_bench && ./zip_bench
+//
+// add -march=native to let the flat_list loops use the wider registers.
+
+#include <list.h>
+#include <flat_list.h>
+#include <bench/bench.h>
+
+struct value_of {
+    float operator()(std::size_t i) const { return static_cast<float>(i % 17) * 0.5f; }
+};
+
+struct fma_ {
+    float operator()(float a, float b, float c) const { return a * b + c; }
+};
+
+template <std::size_t N>
+void bench_flat() {
+    static l::flat_list<float, N> a, b, c;
+    for (std::size_t i = 0; i < N; ++i) {
+        a.data[i] = value_of{}(i);
+        b.data[i] = value_of{}(i + 1);
+        c.data[i] = value_of{}(i + 2);
+    }
+    bench::do_not_optimize(a);
+
+    bench::run("zip", "zip_with", "flat fma", N, [&] {
+        auto r = l::zip_with(fma_{}, a, b, c);
+        bench::do_not_optimize(r);
+    });
+    bench::run("zip", "iteri", "flat fma", N, [&] {
+        l::flat_list<float, N> r{};
+        l::iteri([&](std::size_t i, float e) { r.data[i] = e * b.data[i] + c.data[i]; }, a);
+        bench::do_not_optimize(r);
+    });
+    bench::run("zip", "zip_iter", "flat dot", N, [&] {
+        float s = 0;
+        l::zip_iter([&](float x, float y) { s += x * y; }, a, b);
+        bench::do_not_optimize(s);
+    });
+    bench::run("zip", "iteri", "flat dot", N, [&] {
+        float s = 0;
+        l::iteri([&](std::size_t i, float x) { s += x * b.data[i]; }, a);
+        bench::do_not_optimize(s);
+    });
+    bench::run("zip", "zip_all", "flat a <= b + c", N, [&] {
+        bench::do_not_optimize(l::zip_all([](float x, float y, float z) { return x <= y + z; }, a, b, c));
+    });
+}
+
+template <std::size_t N>
+void bench_cons() {
+    static const auto a = l::generate<N>(value_of{});
+    static const auto b = l::map([](float e) { return e + 0.5f; }, a);
+    static const auto c = l::map([](float e) { return e + 1.0f; }, a);
+
+    bench::run("zip", "zip_with", "cons fma", N, [&] {
+        auto r = l::zip_with(fma_{}, a, b, c);
+        bench::do_not_optimize(r);
+    });
+    bench::run("zip", "mapi + at", "cons fma", N, [&] {
+        auto r = l::mapi([&](std::size_t i, float e) { return e * l::at(b, i) + l::at(c, i); }, a);
+        bench::do_not_optimize(r);
+    });
+    bench::run("zip", "zip_iter", "cons dot", N, [&] {
+        float s = 0;
+        l::zip_iter([&](float x, float y) { s += x * y; }, a, b);
+        bench::do_not_optimize(s);
+    });
+    bench::run("zip", "iteri + at", "cons dot", N, [&] {
+        float s = 0;
+        l::iteri([&](std::size_t i, float x) { s += x * l::at(b, i); }, a);
+        bench::do_not_optimize(s);
+    });
+    bench::run("zip", "nested iter", "cons dot", N, [&] {
+        float s = 0;
+        std::size_t i = 0;
+        l::iter([&](float x) {
+            std::size_t j = 0;
+            l::iter([&](float y) { if (j++ == i) { s += x * y; } }, b);
+            i += 1;
+        }, a);
+        bench::do_not_optimize(s);
+    });
+}
+
+int main() {
+    bench_flat<256>();
+    bench_flat<4096>();
+    bench_cons<16>();
+    bench_cons<128>();
+}
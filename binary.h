@@ -0,0 +1,406 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_BINARY_H
+#define IMM_BINARY_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace l {
+
+class format_error: public std::exception {
+public:
+    std::string what_;
+    format_error() = default;
+    explicit format_error(const std::string& what_arg)
+    : what_(what_arg) {}
+    virtual const char* what() const throw()
+    { if (what_ == "") {return "format_error"; } else { return what_.c_str(); }}
+};
+
+// binary format of a homogeneous list of trivially copyable elements or an
+// assoc list of std::tuple<A, B>:
+//
+//   [header, 64 bytes][keys or elements][padding][values]
+//
+// elements are stored as raw bytes in native byte order, each array starts
+// on a 64 bytes boundary so it can be used in place once the file is
+// mapped. the checksum is a fnv-1a of the arrays, without the padding.
+
+static constexpr std::uint16_t binary_version = 1;
+
+enum class binary_kind : std::uint16_t { list = 0, assoc = 1 };
+
+struct binary_header_ {
+    char magic[4];
+    std::uint32_t byte_order;
+    std::uint16_t version;
+    binary_kind kind;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    std::uint64_t values_offset;
+    std::uint64_t checksum;
+};
+
+static constexpr std::size_t binary_align_ = 64;
+
+constexpr std::uint64_t binary_align_up_(std::uint64_t n) noexcept
+{ return (n + binary_align_ - 1) / binary_align_ * binary_align_; }
+
+struct checksum_ {
+    void update(const void* p, std::size_t n) noexcept {
+        auto b = static_cast<const unsigned char*>(p);
+        for (std::size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 1099511628211ull;
+        }
+    }
+    std::uint64_t h = 14695981039346656037ull;
+};
+
+// assoc entry helper
+
+template <typename T>
+struct binary_pair_ : std::false_type {};
+template <typename A, typename B>
+struct binary_pair_<std::tuple<A, B>> : std::true_type {
+    using key_type = A;
+    using value_type = B;
+};
+
+// write
+
+inline void binary_pad_(std::ostream& os, std::uint64_t from, std::uint64_t to) {
+    static const char zeros[binary_align_] = {};
+    os.write(zeros, static_cast<std::streamsize>(to - from));
+}
+
+inline binary_header_ binary_header_for_(binary_kind kind,
+                                         std::uint32_t key_size,
+                                         std::uint32_t value_size,
+                                         std::uint64_t count,
+                                         std::uint64_t checksum) noexcept {
+    auto values = kind == binary_kind::assoc
+        ? binary_align_up_(binary_align_ + count * key_size)
+        : 0;
+    return binary_header_{{'I', 'M', 'M', 'L'}, 0x01020304u, binary_version, kind,
+                          key_size, value_size, 0, count, values, checksum};
+}
+
+// the elements of a flat_list are contiguous, one call for all of them
+
+template <typename L, typename T>
+void binary_checksum_(checksum_& c, const L& l) {
+    iter([&](const T& e) { c.update(&e, sizeof(T)); }, l);
+}
+
+template <typename L, typename T, std::size_t N>
+void binary_checksum_(checksum_& c, const flat_list<T, N>& l)
+{ c.update(l.data, sizeof(l.data)); }
+
+template <typename L, typename T>
+void binary_write_(std::ostream& os, const L& l) {
+    iter([&](const T& e) { os.write(reinterpret_cast<const char*>(&e), sizeof(T)); }, l);
+}
+
+template <typename L, typename T, std::size_t N>
+void binary_write_(std::ostream& os, const flat_list<T, N>& l)
+{ os.write(reinterpret_cast<const char*>(l.data), sizeof(l.data)); }
+
+// the elements are read twice, once for the checksum then once to be
+// written, nothing is buffered.
+template <typename L,
+          typename T = typename L::head_type,
+          typename = std::enable_if_t<l::is_imm_list<L>::value || l::is_flat_list<L>::value>,
+          typename = std::enable_if_t<not binary_pair_<T>::value>>
+void write_binary(std::ostream& os, const L& l) {
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+    checksum_ c;
+    binary_checksum_<L, T>(c, l);
+    auto h = binary_header_for_(binary_kind::list, sizeof(T), 0, length<L>::value, c.h);
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    binary_pad_(os, sizeof(h), binary_align_);
+    binary_write_<L, T>(os, l);
+}
+
+// keys and values are written as two arrays
+template <typename L,
+          typename T = typename L::head_type,
+          typename = std::enable_if_t<l::is_imm_list<L>::value || l::is_flat_list<L>::value>,
+          typename = std::enable_if_t<binary_pair_<T>::value>,
+          typename = void>
+void write_binary(std::ostream& os, const L& l) {
+    using A = typename binary_pair_<T>::key_type;
+    using B = typename binary_pair_<T>::value_type;
+    static_assert(std::is_trivially_copyable<A>::value, "keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable<B>::value, "values must be trivially copyable");
+    checksum_ c;
+    iter([&](const T& e) { c.update(&std::get<0>(e), sizeof(A)); }, l);
+    iter([&](const T& e) { c.update(&std::get<1>(e), sizeof(B)); }, l);
+    constexpr auto n = length<L>::value;
+    auto h = binary_header_for_(binary_kind::assoc, sizeof(A), sizeof(B), n, c.h);
+    os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    binary_pad_(os, sizeof(h), binary_align_);
+    iter([&](const T& e) { os.write(reinterpret_cast<const char*>(&std::get<0>(e)), sizeof(A)); }, l);
+    binary_pad_(os, binary_align_ + n * sizeof(A), h.values_offset);
+    iter([&](const T& e) { os.write(reinterpret_cast<const char*>(&std::get<1>(e)), sizeof(B)); }, l);
+}
+
+template <typename L>
+void write_binary(const std::string& path, const L& l) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (not os) { throw format_error{"cannot open " + path}; }
+    write_binary(os, l);
+    os.flush();
+    if (not os) { throw format_error{"cannot write " + path}; }
+}
+
+// read only mapping of a whole file, unmapped on destruction
+
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path) {
+        auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { throw format_error{"cannot open " + path}; }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw format_error{"cannot stat " + path};
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ != 0) {
+            auto p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw format_error{"cannot map " + path};
+            }
+            data_ = static_cast<const unsigned char*>(p);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(mapped_file&& o) noexcept
+    : data_(o.data_), size_(o.size_) {
+        o.data_ = nullptr;
+        o.size_ = 0;
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file& operator=(mapped_file&&) = delete;
+
+    ~mapped_file() {
+        if (data_ != nullptr) { ::munmap(const_cast<unsigned char*>(data_), size_); }
+    }
+
+    const unsigned char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// check the header against the expected element sizes, the payload is only
+// read when verify is true so opening a file costs the same for any size.
+inline const binary_header_& binary_check_(const mapped_file& f,
+                                           binary_kind kind,
+                                           std::size_t key_size,
+                                           std::size_t value_size,
+                                           bool verify) {
+    if (f.size() < binary_align_) { throw format_error{"truncated header"}; }
+    auto& h = *reinterpret_cast<const binary_header_*>(f.data());
+    if (std::memcmp(h.magic, "IMML", 4) != 0) { throw format_error{"bad magic"}; }
+    if (h.byte_order != 0x01020304u) { throw format_error{"byte order mismatch"}; }
+    if (h.version != binary_version) { throw format_error{"unsupported version"}; }
+    if (h.kind != kind) { throw format_error{"kind mismatch"}; }
+    if (h.key_size != key_size || h.value_size != value_size) {
+        throw format_error{"element size mismatch"};
+    }
+    // the sizes are checked before they are multiplied, a crafted count
+    // must not wrap around the end of the file.
+    if (h.count > (f.size() - binary_align_) / key_size) { throw format_error{"truncated payload"}; }
+    if (kind == binary_kind::assoc) {
+        if (h.values_offset != binary_align_up_(binary_align_ + h.count * key_size)) {
+            throw format_error{"bad values offset"};
+        }
+        if (h.values_offset > f.size() || h.count > (f.size() - h.values_offset) / value_size) {
+            throw format_error{"truncated payload"};
+        }
+    }
+    if (verify) {
+        checksum_ c;
+        c.update(f.data() + binary_align_, h.count * key_size);
+        if (kind == binary_kind::assoc) { c.update(f.data() + h.values_offset, h.count * value_size); }
+        if (c.h != h.checksum) { throw format_error{"checksum mismatch"}; }
+    }
+    return h;
+}
+
+// read only view of a mapped list, elements are used in place
+
+template <typename T>
+struct mapped_list {
+    using value_type = T;
+
+    explicit mapped_list(mapped_file f, bool verify = false)
+    : file(std::move(f)) {
+        auto& h = binary_check_(file, binary_kind::list, sizeof(T), 0, verify);
+        data = reinterpret_cast<const T*>(file.data() + binary_align_);
+        n = h.count;
+    }
+
+    std::size_t size() const noexcept { return n; }
+
+    mapped_file file;
+    const T* data;
+    std::size_t n;
+};
+
+template <typename T>
+mapped_list<T> load_list(const std::string& path, bool verify = false) {
+    static_assert(std::is_trivially_copyable<T>::value, "elements must be trivially copyable");
+    return mapped_list<T>(mapped_file(path), verify);
+}
+
+template <typename T>
+auto nth(const mapped_list<T>& l, std::size_t i) -> const T& {
+    if (i >= l.n) { throw not_found{"nth"}; }
+    return l.data[i];
+}
+
+template <typename T>
+const T* nth_opt(const mapped_list<T>& l, std::size_t i) noexcept
+{ return i < l.n ? &l.data[i] : nullptr; }
+
+template <typename T, typename Fn>
+void iter(Fn f, const mapped_list<T>& l) {
+    for (std::size_t i = 0; i < l.n; ++i) { f(l.data[i]); }
+}
+
+template <typename T, typename Fn>
+void iteri(Fn f, const mapped_list<T>& l) {
+    for (std::size_t i = 0; i < l.n; ++i) { f(i, l.data[i]); }
+}
+
+// mem, vectorized for int, float and double
+
+template <typename T,
+          typename = std::enable_if_t<not simd::is_simd_type<T>::value>>
+bool mem(const T& a, const mapped_list<T>& l) noexcept {
+    for (std::size_t i = 0; i < l.n; ++i) {
+        if (l.data[i] == a) { return true; }
+    }
+    return false;
+}
+
+template <typename T,
+          typename = std::enable_if_t<simd::is_simd_type<T>::value>,
+          typename = void>
+bool mem(const T& a, const mapped_list<T>& l) noexcept
+{ return simd::find_first<cmp_op::eq>(l.data, l.n, a) != l.n; }
+
+// read only view of a mapped assoc list
+
+template <typename A, typename B>
+struct mapped_assoc {
+    using key_type = A;
+    using value_type = B;
+
+    explicit mapped_assoc(mapped_file f, bool verify = false)
+    : file(std::move(f)) {
+        auto& h = binary_check_(file, binary_kind::assoc, sizeof(A), sizeof(B), verify);
+        keys = reinterpret_cast<const A*>(file.data() + binary_align_);
+        values = reinterpret_cast<const B*>(file.data() + h.values_offset);
+        n = h.count;
+    }
+
+    std::size_t size() const noexcept { return n; }
+
+    mapped_file file;
+    const A* keys;
+    const B* values;
+    std::size_t n;
+};
+
+template <typename A, typename B>
+mapped_assoc<A, B> load_assoc(const std::string& path, bool verify = false) {
+    static_assert(std::is_trivially_copyable<A>::value, "keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable<B>::value, "values must be trivially copyable");
+    return mapped_assoc<A, B>(mapped_file(path), verify);
+}
+
+// position of the first entry with key a, the keys are scanned in place
+
+template <typename A,
+          typename = std::enable_if_t<not simd::is_simd_type<A>::value>>
+std::size_t mapped_find_key_(const A* keys, std::size_t n, const A& a) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (keys[i] == a) { return i; }
+    }
+    return n;
+}
+
+template <typename A,
+          typename = std::enable_if_t<simd::is_simd_type<A>::value>,
+          typename = void>
+std::size_t mapped_find_key_(const A* keys, std::size_t n, const A& a) noexcept
+{ return simd::find_first<cmp_op::eq>(keys, n, a); }
+
+template <typename A, typename B>
+auto assoc(const A& a, const mapped_assoc<A, B>& l) -> const B& {
+    auto i = mapped_find_key_(l.keys, l.n, a);
+    if (i == l.n) { throw not_found{}; }
+    return l.values[i];
+}
+
+template <typename A, typename B>
+const B* assoc_opt(const A& a, const mapped_assoc<A, B>& l) noexcept {
+    auto i = mapped_find_key_(l.keys, l.n, a);
+    return i == l.n ? nullptr : &l.values[i];
+}
+
+template <typename A, typename B>
+bool mem_assoc(const A& a, const mapped_assoc<A, B>& l) noexcept
+{ return mapped_find_key_(l.keys, l.n, a) != l.n; }
+
+// f is called with the key and the value of each entry
+template <typename A, typename B, typename Fn>
+void iter(Fn f, const mapped_assoc<A, B>& l) {
+    for (std::size_t i = 0; i < l.n; ++i) { f(l.keys[i], l.values[i]); }
+}
+
+} // l
+
+#endif // IMM_BINARY_H
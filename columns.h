@@ -0,0 +1,200 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_COLUMNS_H
+#define IMM_COLUMNS_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <simd.h>
+#include <tuple>
+#include <utility>
+
+namespace l {
+
+// keys and values of an assoc list stored as two separate arrays, in the
+// order of the list. a lookup only scans the keys (with simd for int,
+// float and double keys) then reads one value at the position found.
+template <typename A, typename B, std::size_t N>
+struct assoc_columns {
+    using key_type = A;
+    using value_type = B;
+    flat_list<A, N> keys;
+    flat_list<B, N> values;
+};
+
+// is assoc columns helper
+
+template <typename T>
+struct is_assoc_columns : std::false_type {};
+template <typename A, typename B, std::size_t N>
+struct is_assoc_columns<assoc_columns<A, B, N>> : std::true_type {};
+
+// get the list size
+
+template <std::size_t N, typename A, typename B, std::size_t M>
+struct length_<N, assoc_columns<A, B, M>> {
+    static constexpr std::size_t value = N + M;
+};
+
+// split, List.split: an assoc list to its keys and its values
+
+// filled in a loop when possible, a pack of N elements is slow to compile
+// for large lists
+template <typename A, typename B, std::size_t N>
+constexpr auto split_(const flat_list<std::tuple<A, B>, N>& l, std::true_type) noexcept
+    -> assoc_columns<A, B, N>
+{
+    assoc_columns<A, B, N> r{};
+    for (std::size_t i = 0; i < N; ++i) {
+        r.keys.data[i] = std::get<0>(l.data[i]);
+        r.values.data[i] = std::get<1>(l.data[i]);
+    }
+    return r;
+}
+
+template <typename A, typename B, std::size_t N, std::size_t... I>
+constexpr auto split_(const flat_list<std::tuple<A, B>, N>& l, std::index_sequence<I...>) noexcept
+    -> assoc_columns<A, B, N>
+{
+    return assoc_columns<A, B, N>{
+        {{std::get<0>(l.data[I])...}},
+        {{std::get<1>(l.data[I])...}}
+    };
+}
+
+template <typename A, typename B, std::size_t N>
+constexpr auto split_(const flat_list<std::tuple<A, B>, N>& l, std::false_type) noexcept
+    -> assoc_columns<A, B, N>
+{ return split_(l, std::make_index_sequence<N>{}); }
+
+template <typename A, typename B, std::size_t N>
+constexpr auto split(const flat_list<std::tuple<A, B>, N>& l) noexcept
+    -> assoc_columns<A, B, N>
+{
+    return split_(l, std::integral_constant<bool,
+                                            std::is_default_constructible<A>::value &&
+                                            std::is_default_constructible<B>::value>{});
+}
+
+// the columns of a cons_ assoc list, see split for two cons_ lists
+template <typename A, typename B, typename Tail>
+constexpr auto to_columns(const cons_<std::tuple<A, B>, Tail>& l) noexcept
+    -> assoc_columns<A, B, length<cons_<std::tuple<A, B>, Tail>>::value>
+{ return split(to_flat(l)); }
+
+template <typename A, typename B, typename Tail>
+constexpr auto split(const cons_<std::tuple<A, B>, Tail>& l) noexcept
+    -> std::pair<typename list_type_from_size<A, length<cons_<std::tuple<A, B>, Tail>>::value>::type,
+                 typename list_type_from_size<B, length<cons_<std::tuple<A, B>, Tail>>::value>::type>
+{
+    const auto c = to_columns(l);
+    return std::make_pair(to_cons(c.keys), to_cons(c.values));
+}
+
+// combine, List.combine: keys and values to an assoc list
+
+// tuples can not be assigned in a constant expression, built from a pack
+template <typename A, typename B, std::size_t N, std::size_t... I>
+constexpr auto combine_(const flat_list<A, N>& k, const flat_list<B, N>& v, std::index_sequence<I...>) noexcept
+    -> flat_list<std::tuple<A, B>, N>
+{ return flat_list<std::tuple<A, B>, N>{{std::tuple<A, B>(k.data[I], v.data[I])...}}; }
+
+template <typename A, std::size_t N, typename B, std::size_t M>
+constexpr auto combine(const flat_list<A, N>& k, const flat_list<B, M>& v) noexcept
+    -> flat_list<std::tuple<A, B>, N>
+{
+    static_assert(N == M, "combine lists of different lengths");
+    return combine_(k, v, std::make_index_sequence<N>{});
+}
+
+template <typename A, typename B, std::size_t N>
+constexpr auto combine(const assoc_columns<A, B, N>& c) noexcept
+    -> flat_list<std::tuple<A, B>, N>
+{ return combine(c.keys, c.values); }
+
+template <typename L1,
+          typename L2,
+          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
+          typename = std::enable_if_t<l::is_imm_list<L2>::value>>
+constexpr auto combine(const L1& k, const L2& v) noexcept
+    -> typename list_type_from_size<std::tuple<typename L1::head_type, typename L2::head_type>,
+                                    length<L1>::value>::type
+{
+    static_assert(length<L1>::value == length<L2>::value, "combine lists of different lengths");
+    return to_cons(combine(to_flat(k), to_flat(v)));
+}
+
+// assoc_pos, position of the first key equal to a, N if none
+
+template <typename A, std::size_t N>
+constexpr std::size_t key_pos_(const A& a, const flat_list<A, N>& k, std::false_type) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (k.data[i] == a) { return i; }
+    }
+    return N;
+}
+
+template <typename A, std::size_t N>
+constexpr std::size_t key_pos_(const A& a, const flat_list<A, N>& k, std::true_type) noexcept {
+    if (not IMM_IS_CONSTANT_EVALUATED()) { return simd::find_first<cmp_op::eq>(k.data, N, a); }
+    return key_pos_(a, k, std::false_type{});
+}
+
+template <typename A, typename B, std::size_t N>
+constexpr std::size_t assoc_pos(const A& a, const assoc_columns<A, B, N>& c) noexcept
+{ return key_pos_(a, c.keys, simd::is_simd_type<A>{}); }
+
+// assoc
+
+template <typename A, typename B, std::size_t N>
+constexpr auto assoc(const A& a, const assoc_columns<A, B, N>& c) -> B {
+    auto i = assoc_pos(a, c);
+    if (i == N) { throw not_found{}; }
+    return c.values.data[i];
+}
+
+// assoc_opt, pointer to the value or nullptr
+
+template <typename A, typename B, std::size_t N>
+constexpr const B* assoc_opt(const A& a, const assoc_columns<A, B, N>& c) noexcept {
+    auto i = assoc_pos(a, c);
+    return i == N ? nullptr : &c.values.data[i];
+}
+
+// mem_assoc
+
+template <typename A, typename B, std::size_t N>
+constexpr bool mem_assoc(const A& a, const assoc_columns<A, B, N>& c) noexcept
+{ return assoc_pos(a, c) != N; }
+
+} // l
+
+template <typename A,
+          typename B,
+          std::size_t N>
+std::ostream& operator<<(std::ostream& os, const l::assoc_columns<A, B, N>& c) {
+    os << "{keys: " << c.keys << ", values: " << c.values << "}";
+    return os;
+}
+
+#endif // IMM_COLUMNS_H
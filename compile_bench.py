@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Jeremy Letang
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# compile time benchmark of the list.h metafunctions.
+#
+# every (operation, size) pair is generated as its own translation unit and
+# compiled in isolation, the wall time, the peak memory of the compiler,
+# the number of instantiated functions found in the object file, the size
+# of its code and of its symbol table are reported as json. a previous
+# report given with --baseline is compared on the object sizes, the ratios
+# above the threshold make the exit status 1.
+#
+#   ./compile_bench.py --sizes 8,64,256 --ops rev,map -o bench.json
+#   ./compile_bench.py --ops construct --builders cons,make_list,generate
+#   ./compile_bench.py -I path/to/other/impl   # compare another list.h
+#   ./compile_bench.py --ops rev,append,map --sizes 16,64,256,1024 \
+#       --baseline before.json --threshold 1.10
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+DEFAULT_SIZES = [8, 64, 256, 1024, 2048]
+
+# body of main() for each operation, `a` is the generated list and `L` its type.
+OPS = {
+    "construct": "",
+    "length": "static_assert(l::length<L>::value == {n}, \"length\");",
+    "nth": "volatile int r = l::nth<{last}>(a); (void)r;",
+    "rev": "auto r = l::rev(a); (void)r;",
+    "append": "auto r = l::append(a, a); (void)r;",
+    "map": "auto r = l::map([](int e) {{ return e + 1; }}, a); (void)r;",
+    "mapi": "auto r = l::mapi([](std::size_t i, int e) {{ return e + i; }}, a); (void)r;",
+    "iter": "int s = 0; l::iter([&](int e) {{ s += e; }}, a); volatile int r = s; (void)r;",
+    "mem": "volatile bool r = l::mem(-1, a); (void)r;",
+}
+
+# expression building the list `a` of n ints.
+BUILDERS = {
+    "cons": lambda n: _nested(n),
+    "make_list": lambda n: "l::make_list({})".format(", ".join(map(str, range(n)))),
+    "from_array": lambda n: "l::from_array(std::array<int, {}>{{{{{}}}}})".format(
+        n, ", ".join(map(str, range(n)))),
+    "generate": lambda n: "l::generate<{}>([](std::size_t i) {{ return static_cast<int>(i); }})".format(n),
+}
+
+
+def _nested(n):
+    lst = "nil"
+    for i in range(n):
+        lst = "cons({}, {})".format(i, lst)
+    return lst
+
+
+def make_source(op, n, builder="cons"):
+    lst = BUILDERS[builder](n)
+    body = OPS[op].format(n=n, last=n - 1)
+    return (
+        "#include <list.h>\n"
+        "int main() {{\n"
+        "    const auto a = {lst};\n"
+        "    using L = decltype(a);\n"
+        "    (void)sizeof(L);\n"
+        "    {body}\n"
+        "}}\n"
+    ).format(lst=lst, body=body)
+
+
+def count_instantiations(obj):
+    try:
+        out = subprocess.run(["nm", "--defined-only", obj],
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.DEVNULL,
+                             universal_newlines=True,
+                             check=True).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    # mangled names are used, the demangler gives up on very long ones.
+    return sum(1 for line in out.splitlines()
+               if line.split()[-1].startswith("_Z"))
+
+
+# bytes of code (.text and the .text.* sections of the inline functions)
+# and of the symbol table (.symtab and the names in .strtab).
+def section_sizes(obj):
+    try:
+        out = subprocess.run(["readelf", "-SW", obj],
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.DEVNULL,
+                             universal_newlines=True,
+                             check=True).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return None, None
+    text = symtab = 0
+    for line in out.splitlines():
+        # [Nr] Name Type Address Off Size ..., the index may be "[ 1]"
+        fields = line.replace("[ ", "[").split()
+        if len(fields) < 6 or not fields[0].startswith("["):
+            continue
+        name = fields[1]
+        try:
+            n = int(fields[5], 16)
+        except ValueError:
+            continue
+        if name == ".text" or name.startswith(".text."):
+            text += n
+        elif name in (".symtab", ".strtab"):
+            symtab += n
+    return text, symtab
+
+
+def compile_one(args, op, n, builder, workdir):
+    src = os.path.join(workdir, "{}_{}_{}.cpp".format(op, builder, n))
+    obj = os.path.join(workdir, "{}_{}_{}.o".format(op, builder, n))
+    with open(src, "w") as f:
+        f.write(make_source(op, n, builder))
+
+    cmd = [args.cxx, "-std=" + args.std, "-c", src, "-o", obj,
+           "-ftemplate-depth={}".format(args.template_depth)]
+    cmd += ["-I" + d for d in args.include]
+    cmd += args.cxxflags
+
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    # wait4 gives the rusage of this compiler run only, children included.
+    _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.perf_counter() - start
+    err = proc.stderr.read().decode(errors="replace")
+    proc.stderr.close()
+
+    ok = os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+    text, symtab = section_sizes(obj) if ok else (None, None)
+    res = {
+        "op": op,
+        "builder": builder,
+        "size": n,
+        "status": "ok" if ok else "error",
+        "wall_s": round(wall, 4),
+        "peak_rss_kb": rusage.ru_maxrss,
+        "instantiations": count_instantiations(obj) if ok else None,
+        "object_bytes": os.path.getsize(obj) if ok else None,
+        "text_bytes": text,
+        "symtab_bytes": symtab,
+    }
+    if not ok:
+        res["error"] = err.strip().splitlines()[-1] if err.strip() else "compiler failed"
+    return res
+
+
+SIZE_FIELDS = ["instantiations", "text_bytes", "symtab_bytes"]
+
+
+# ratios new / old of the size fields, the ones above threshold are regressions
+def compare(old, new, threshold):
+    before = {(r["op"], r["builder"], r["size"]): r for r in old["results"]}
+    regressions = []
+    for r in new["results"]:
+        o = before.get((r["op"], r["builder"], r["size"]))
+        if o is None:
+            continue
+        for field in SIZE_FIELDS:
+            if not o.get(field) or r.get(field) is None:
+                continue
+            ratio = r[field] / o[field]
+            if ratio > threshold:
+                regressions.append((ratio, field, r, o))
+    regressions.sort(key=lambda e: -e[0])
+    for ratio, field, r, o in regressions:
+        print("{:>6.2f}x  {} {} {} {}: {} -> {}".format(
+            ratio, r["op"], r["builder"], r["size"], field, o[field], r[field]))
+    print("{} regressions above {:.2f}x".format(len(regressions), threshold), file=sys.stderr)
+    return regressions
+
+
+def main():
+    p = argparse.ArgumentParser(description="compile time benchmark for list.h")
+    p.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    p.add_argument("--std", default="c++14")
+    p.add_argument("--sizes", default=",".join(map(str, DEFAULT_SIZES)))
+    p.add_argument("--ops", default=",".join(OPS))
+    p.add_argument("--builders", default="cons",
+                   help="how the list is built, one or more of " + ", ".join(BUILDERS))
+    p.add_argument("-I", "--include", action="append", default=[],
+                   help="directory containing the list.h to benchmark (default: this repo)")
+    p.add_argument("--template-depth", type=int, default=100000)
+    p.add_argument("--cxxflags", default="", help="extra compiler flags")
+    p.add_argument("--baseline", help="previous json report to compare with")
+    p.add_argument("--threshold", type=float, default=1.10,
+                   help="ratio of the object sizes reported as a regression")
+    p.add_argument("-o", "--output", help="json output file (default: stdout)")
+    p.add_argument("--keep", action="store_true", help="keep generated sources")
+    args = p.parse_args()
+
+    if not args.include:
+        args.include = [os.path.dirname(os.path.abspath(__file__))]
+    args.cxxflags = args.cxxflags.split()
+    sizes = [int(s) for s in args.sizes.split(",") if s]
+    ops = [o for o in args.ops.split(",") if o]
+    for op in ops:
+        if op not in OPS:
+            p.error("unknown op '{}', expected one of {}".format(op, ", ".join(OPS)))
+    builders = [b for b in args.builders.split(",") if b]
+    for b in builders:
+        if b not in BUILDERS:
+            p.error("unknown builder '{}', expected one of {}".format(b, ", ".join(BUILDERS)))
+
+    workdir = tempfile.mkdtemp(prefix="tmule_bench_")
+    results = []
+    for op in ops:
+        for builder in builders:
+            for n in sizes:
+                r = compile_one(args, op, n, builder, workdir)
+                results.append(r)
+                print("{:>10} {:>10} {:>6}  {:>6}  {:>9.3f}s  {:>8} KB  {:>6} inst  {:>9} text  {:>9} symtab".format(
+                    op, builder, n, r["status"], r["wall_s"], r["peak_rss_kb"],
+                    r["instantiations"] if r["instantiations"] is not None else "-",
+                    r["text_bytes"] if r["text_bytes"] is not None else "-",
+                    r["symtab_bytes"] if r["symtab_bytes"] is not None else "-"),
+                    file=sys.stderr)
+
+    if args.keep:
+        print("generated sources kept in " + workdir, file=sys.stderr)
+    else:
+        for f in os.listdir(workdir):
+            os.remove(os.path.join(workdir, f))
+        os.rmdir(workdir)
+
+    report = {
+        "compiler": args.cxx,
+        "std": args.std,
+        "include": args.include,
+        "results": results,
+    }
+    out = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(out + "\n")
+    else:
+        print(out)
+
+    failed = not all(r["status"] == "ok" for r in results)
+    if args.baseline:
+        with open(args.baseline) as f:
+            if compare(json.load(f), report, args.threshold):
+                failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
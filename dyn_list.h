@@ -0,0 +1,361 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_DYN_LIST_H
+#define IMM_DYN_LIST_H
+
+#include <list.h>
+#include <arena.h>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+namespace l {
+
+// immutable list which length is only known at run time. elements are
+// stored in unrolled chunks of about 256 bytes aligned on a cache line,
+// a traversal touches one chunk for many elements instead of one node per
+// element. chunks are allocated in an arena and shared between lists the
+// same way as plist nodes: tl is O(1) and append shares its second list.
+// the lists are valid as long as their arena is alive, an arena with
+// blocks of several chunks (64KiB) is best for large lists.
+
+// element storage of a chunk, elements are only destroyed when they need
+// to be so the arena does not register a cleanup for chunks of int.
+
+template <typename T, std::size_t N, bool = std::is_trivially_destructible<T>::value>
+struct dyn_storage_ {
+    T* data() noexcept { return reinterpret_cast<T*>(storage); }
+    const T* data() const noexcept { return reinterpret_cast<const T*>(storage); }
+
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage[N];
+    // used elements
+    std::size_t count = 0;
+};
+
+template <typename T, std::size_t N>
+struct dyn_storage_<T, N, false> : dyn_storage_<T, N, true> {
+    dyn_storage_() = default;
+    dyn_storage_(const dyn_storage_&) = delete;
+    dyn_storage_& operator=(const dyn_storage_&) = delete;
+    ~dyn_storage_() {
+        for (std::size_t i = 0; i < this->count; ++i) { this->data()[i].~T(); }
+    }
+};
+
+template <typename T>
+struct dyn_capacity_ {
+    static constexpr std::size_t bytes = 256;
+    static constexpr std::size_t value = sizeof(T) * 4 > bytes ? 4 : bytes / sizeof(T);
+};
+
+template <typename T>
+struct alignas(64) dyn_chunk_ : dyn_storage_<T, dyn_capacity_<T>::value> {
+    static constexpr std::size_t capacity = dyn_capacity_<T>::value;
+
+    // elements from data()[0] to the end of the list
+    std::size_t size = 0;
+    // the list continues at next->data()[next_offset]
+    const dyn_chunk_* next = nullptr;
+    std::size_t next_offset = 0;
+};
+
+template <typename T>
+struct dyn_list {
+    using value_type = T;
+    using chunk_type = dyn_chunk_<T>;
+
+    constexpr explicit dyn_list(arena& a) noexcept
+    : c(nullptr), off(0), a(&a) {}
+    constexpr dyn_list(const chunk_type* c, std::size_t off, arena* a) noexcept
+    : c(c), off(off), a(a) {}
+
+    bool empty() const noexcept { return c == nullptr; }
+    std::size_t size() const noexcept { return c == nullptr ? 0 : c->size - off; }
+
+    // first element is c->data()[off]
+    const chunk_type* c;
+    std::size_t off;
+    arena* a;
+};
+
+// is dyn list helper
+
+template <typename T>
+struct is_dyn_list : std::false_type {};
+template <typename T>
+struct is_dyn_list<dyn_list<T>> : std::true_type {};
+
+// call f(p, n) on each contiguous run of elements, stop when f returns false
+template <typename T, typename Fn>
+bool dyn_for_runs_(const dyn_list<T>& l, Fn f) {
+    auto off = l.off;
+    for (auto c = l.c; c != nullptr; c = c->next) {
+        if (not f(c->data() + off, c->count - off)) { return false; }
+        off = c->next_offset;
+    }
+    return true;
+}
+
+// chunks are filled in order then linked to a tail, they are only
+// published as const once complete.
+template <typename T>
+struct dyn_builder_ {
+    using chunk_type = dyn_chunk_<T>;
+
+    explicit dyn_builder_(arena& a) noexcept
+    : a(a) {}
+
+    void reserve_() {
+        if (last == nullptr || last->count == chunk_type::capacity) {
+            // default initialized, a.make<chunk_type>() would value initialize
+            // it and zero the element storage before it is written
+            auto c = new (a.allocate(sizeof(chunk_type), alignof(chunk_type))) chunk_type;
+            a.destroy_later(c, 1);
+            if (last == nullptr) { first = c; } else { last->next = c; }
+            last = c;
+        }
+    }
+
+    template <typename U>
+    void push(U&& v) {
+        reserve_();
+        new (last->data() + last->count) T(std::forward<U>(v));
+        last->count += 1;
+    }
+
+    // fill a whole chunk per iteration, the count stays in a register
+    template <typename It>
+    void push_range(It b, It e) {
+        while (b != e) {
+            reserve_();
+            auto p = last->data();
+            auto n = last->count;
+            for (; n < chunk_type::capacity && b != e; ++n, ++b) { new (p + n) T(*b); }
+            last->count = n;
+        }
+    }
+
+    dyn_list<T> finish(const dyn_list<T>& tail) noexcept {
+        if (last == nullptr) { return dyn_list<T>(tail.c, tail.off, &a); }
+        last->next = tail.c;
+        last->next_offset = tail.off;
+        std::size_t total = tail.size();
+        for (auto c = first; c != nullptr; c = const_cast<chunk_type*>(c->next)) {
+            total += c->count;
+            if (c == last) { break; }
+        }
+        for (auto c = first; c != nullptr; c = const_cast<chunk_type*>(c->next)) {
+            c->size = total;
+            total -= c->count;
+            if (c == last) { break; }
+        }
+        return dyn_list<T>(first, 0, &a);
+    }
+
+    dyn_list<T> finish() noexcept { return finish(dyn_list<T>(a)); }
+
+    arena& a;
+    chunk_type* first = nullptr;
+    chunk_type* last = nullptr;
+};
+
+// construction
+
+template <typename T, typename It>
+dyn_list<T> make_dyn_list(arena& a, It first, It last) {
+    dyn_builder_<T> b(a);
+    b.push_range(first, last);
+    return b.finish();
+}
+
+template <typename T>
+dyn_list<T> make_dyn_list(arena& a, std::initializer_list<T> l)
+{ return make_dyn_list<T>(a, l.begin(), l.end()); }
+
+// hd / tl
+
+template <typename T>
+auto hd(const dyn_list<T>& l) -> const T& {
+    if (l.empty()) { throw not_found{"hd"}; }
+    return l.c->data()[l.off];
+}
+
+template <typename T>
+auto tl(const dyn_list<T>& l) -> dyn_list<T> {
+    if (l.empty()) { throw not_found{"tl"}; }
+    if (l.off + 1 < l.c->count) { return dyn_list<T>(l.c, l.off + 1, l.a); }
+    return dyn_list<T>(l.c->next, l.c->next_offset, l.a);
+}
+
+// nth, skips whole chunks
+
+template <typename T>
+auto nth(const dyn_list<T>& l, std::size_t i) -> const T& {
+    if (i >= l.size()) { throw not_found{"nth"}; }
+    auto c = l.c;
+    auto off = l.off;
+    while (i >= c->count - off) {
+        i -= c->count - off;
+        off = c->next_offset;
+        c = c->next;
+    }
+    return c->data()[off + i];
+}
+
+// iter
+
+template <typename T, typename Fn>
+void iter(Fn f, const dyn_list<T>& l) {
+    dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) { f(p[i]); }
+        return true;
+    });
+}
+
+// iteri
+
+template <typename T, typename Fn>
+void iteri(Fn f, const dyn_list<T>& l) {
+    std::size_t k = 0;
+    dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) { f(k++, p[i]); }
+        return true;
+    });
+}
+
+// map
+
+template <typename Fn, typename T>
+auto map(Fn f, const dyn_list<T>& l)
+    -> dyn_list<std::decay_t<decltype(f(std::declval<const T&>()))>> {
+    dyn_builder_<std::decay_t<decltype(f(std::declval<const T&>()))>> b(*l.a);
+    iter([&](const T& e) { b.push(f(e)); }, l);
+    return b.finish();
+}
+
+// mapi
+
+template <typename Fn, typename T>
+auto mapi(Fn f, const dyn_list<T>& l)
+    -> dyn_list<std::decay_t<decltype(f(std::size_t{0}, std::declval<const T&>()))>> {
+    dyn_builder_<std::decay_t<decltype(f(std::size_t{0}, std::declval<const T&>()))>> b(*l.a);
+    iteri([&](std::size_t i, const T& e) { b.push(f(i, e)); }, l);
+    return b.finish();
+}
+
+// rev, the chunks are walked once to collect them then read backward
+
+template <typename T>
+auto rev_append(const dyn_list<T>& l1, const dyn_list<T>& l2) -> dyn_list<T> {
+    std::size_t runs = 0;
+    dyn_for_runs_(l1, [&](const T*, std::size_t) { runs += 1; return true; });
+    struct run_ { const T* p; std::size_t n; };
+    auto rs = static_cast<run_*>(l1.a->allocate(sizeof(run_) * (runs + 1), alignof(run_)));
+    std::size_t k = 0;
+    dyn_for_runs_(l1, [&](const T* p, std::size_t n) { rs[k++] = run_{p, n}; return true; });
+    dyn_builder_<T> b(*l1.a);
+    while (k > 0) {
+        k -= 1;
+        for (auto i = rs[k].n; i > 0; --i) { b.push(rs[k].p[i - 1]); }
+    }
+    return b.finish(l2);
+}
+
+template <typename T>
+auto rev(const dyn_list<T>& l) -> dyn_list<T>
+{ return rev_append(l, dyn_list<T>(*l.a)); }
+
+// append, l1 is copied and l2 is shared
+
+template <typename T>
+auto append(const dyn_list<T>& l1, const dyn_list<T>& l2) -> dyn_list<T> {
+    dyn_builder_<T> b(*l1.a);
+    dyn_for_runs_(l1, [&](const T* p, std::size_t n) { b.push_range(p, p + n); return true; });
+    return b.finish(l2);
+}
+
+// mem
+
+template <typename T>
+bool mem(const T& a, const dyn_list<T>& l) {
+    return not dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (p[i] == a) { return false; }
+        }
+        return true;
+    });
+}
+
+// exists
+
+template <typename T, typename Fn>
+bool exists(Fn f, const dyn_list<T>& l) {
+    return not dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (f(p[i])) { return false; }
+        }
+        return true;
+    });
+}
+
+// for_all
+
+template <typename T, typename Fn>
+bool for_all(Fn f, const dyn_list<T>& l) {
+    return dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (not f(p[i])) { return false; }
+        }
+        return true;
+    });
+}
+
+// find
+
+template <typename T, typename Fn>
+auto find(Fn f, const dyn_list<T>& l) -> T {
+    const T* r = nullptr;
+    dyn_for_runs_(l, [&](const T* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (f(p[i])) { r = p + i; return false; }
+        }
+        return true;
+    });
+    if (r == nullptr) { throw not_found{}; }
+    return *r;
+}
+
+} // l
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const l::dyn_list<T>& l) {
+    os << "[";
+    l::iteri([&](std::size_t i, const T& e) {
+        if (i != 0) { os << ", "; }
+        os << e;
+    }, l);
+    os << "]";
+    return os;
+}
+
+#endif // IMM_DYN_LIST_H
@@ -0,0 +1,422 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_FLAT_LIST_H
+#define IMM_FLAT_LIST_H
+
+#include <list.h>
+#include <simd.h>
+#include <utility>
+
+namespace l {
+
+// homogeneous list of N elements stored in one contiguous array,
+// algorithms are plain loops instead of one recursive call per element.
+template <typename T, std::size_t N>
+struct flat_list {
+    static_assert(N >= 1, "flat_list must contains at least one element");
+    using head_type = T;
+    using value_type = T;
+    T data[N];
+};
+
+// is flat list helper
+
+template <typename T>
+struct is_flat_list : std::false_type {};
+template <typename T, std::size_t N>
+struct is_flat_list<flat_list<T, N>> : std::true_type {};
+
+// get the list size
+
+template <std::size_t N, typename T, std::size_t M>
+struct length_<N, flat_list<T, M>> {
+    static constexpr std::size_t value = N + M;
+};
+
+// nth
+
+template <std::size_t I,
+          typename T,
+          std::size_t N,
+          typename = std::enable_if_t<(I < N)>>
+constexpr auto nth(const flat_list<T, N>& l) noexcept -> T
+{ return l.data[I]; }
+
+// hd / tl
+
+template <typename T, std::size_t N>
+constexpr auto hd(const flat_list<T, N>& l) noexcept -> T
+{ return l.data[0]; }
+
+template <typename T, std::size_t N, std::size_t... I>
+constexpr auto tl_(const flat_list<T, N>& l, std::index_sequence<I...>) noexcept
+    -> flat_list<T, N - 1>
+{ return flat_list<T, N - 1>{{l.data[I + 1]...}}; }
+
+template <typename T,
+          std::size_t N,
+          typename = std::enable_if_t<(N > 1)>>
+constexpr auto tl(const flat_list<T, N>& l) noexcept -> flat_list<T, N - 1>
+{ return tl_(l, std::make_index_sequence<N - 1>{}); }
+
+// tail of a one element list is nil, like cons_<Head, nil_t>
+template <typename T>
+constexpr nil_t tl(const flat_list<T, 1>&) noexcept
+{ return nil_t{}; }
+
+// iter
+
+template <typename T, std::size_t N, typename Fn>
+constexpr void iter(Fn f, const flat_list<T, N>& l) {
+    for (std::size_t i = 0; i < N; ++i) { f(l.data[i]); }
+}
+
+// iteri
+
+template <typename T, std::size_t N, typename Fn>
+constexpr void iteri(Fn f, const flat_list<T, N>& l) {
+    for (std::size_t i = 0; i < N; ++i) { f(i, l.data[i]); }
+}
+
+// map
+
+template <typename Fn, typename T, std::size_t N, std::size_t... I>
+constexpr auto flat_map_(Fn f, const flat_list<T, N>& l, std::index_sequence<I...>) noexcept
+    -> flat_list<decltype(f(l.data[0])), N>
+{ return flat_list<decltype(f(l.data[0])), N>{{f(l.data[I])...}}; }
+
+template <typename Fn, typename T, std::size_t N>
+constexpr auto map(Fn f, const flat_list<T, N>& l) noexcept
+    -> flat_list<decltype(f(l.data[0])), N>
+{ return flat_map_(f, l, std::make_index_sequence<N>{}); }
+
+// mapi
+
+template <typename Fn, typename T, std::size_t N, std::size_t... I>
+constexpr auto flat_mapi_(Fn f, const flat_list<T, N>& l, std::index_sequence<I...>) noexcept
+    -> flat_list<decltype(f(std::size_t{0}, l.data[0])), N>
+{ return flat_list<decltype(f(std::size_t{0}, l.data[0])), N>{{f(I, l.data[I])...}}; }
+
+template <typename Fn, typename T, std::size_t N>
+constexpr auto mapi(Fn f, const flat_list<T, N>& l) noexcept
+    -> flat_list<decltype(f(std::size_t{0}, l.data[0])), N>
+{ return flat_mapi_(f, l, std::make_index_sequence<N>{}); }
+
+// rev
+
+template <typename T, std::size_t N, std::size_t... I>
+constexpr auto flat_rev_(const flat_list<T, N>& l, std::index_sequence<I...>) noexcept
+    -> flat_list<T, N>
+{ return flat_list<T, N>{{l.data[N - 1 - I]...}}; }
+
+template <typename T, std::size_t N>
+constexpr auto rev(const flat_list<T, N>& l) noexcept -> flat_list<T, N>
+{ return flat_rev_(l, std::make_index_sequence<N>{}); }
+
+// append
+
+template <typename T, std::size_t N, std::size_t M, std::size_t... I, std::size_t... J>
+constexpr auto flat_append_(const flat_list<T, N>& l1,
+                            const flat_list<T, M>& l2,
+                            std::index_sequence<I...>,
+                            std::index_sequence<J...>) noexcept
+    -> flat_list<T, N + M>
+{ return flat_list<T, N + M>{{l1.data[I]..., l2.data[J]...}}; }
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto append(const flat_list<T, N>& l1, const flat_list<T, M>& l2) noexcept
+    -> flat_list<T, N + M>
+{
+    return flat_append_(l1, l2,
+                        std::make_index_sequence<N>{},
+                        std::make_index_sequence<M>{});
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto rev_append(const flat_list<T, N>& l1, const flat_list<T, M>& l2) noexcept
+    -> flat_list<T, N + M>
+{ return append(rev(l1), l2); }
+
+// mem, vectorized for int, float and double outside of constant expressions
+
+template <typename A, std::size_t N>
+constexpr bool mem_(const A& a, const flat_list<A, N>& l, std::false_type) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (l.data[i] == a) { return true; }
+    }
+    return false;
+}
+
+template <typename A, std::size_t N>
+constexpr bool mem_(const A& a, const flat_list<A, N>& l, std::true_type) noexcept {
+    if (not IMM_IS_CONSTANT_EVALUATED()) { return simd::find_first<cmp_op::eq>(l.data, N, a) != N; }
+    return mem_(a, l, std::false_type{});
+}
+
+template <typename A, std::size_t N>
+constexpr bool mem(const A& a, const flat_list<A, N>& l) noexcept
+{ return mem_(a, l, simd::is_simd_type<A>{}); }
+
+// exists
+
+template <typename T, std::size_t N, typename Fn>
+bool exists(Fn f, const flat_list<T, N>& l) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (f(l.data[i])) { return true; }
+    }
+    return false;
+}
+
+template <cmp_op Op,
+          typename T,
+          std::size_t N,
+          typename = std::enable_if_t<simd::is_simd_type<T>::value>>
+bool exists(cmp_<Op, T> f, const flat_list<T, N>& l) noexcept
+{ return simd::find_first<Op>(l.data, N, f.v) != N; }
+
+// for_all
+
+template <typename T, std::size_t N, typename Fn>
+bool for_all(Fn f, const flat_list<T, N>& l) noexcept {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (not f(l.data[i])) { return false; }
+    }
+    return true;
+}
+
+template <cmp_op Op,
+          typename T,
+          std::size_t N,
+          typename = std::enable_if_t<simd::is_simd_type<T>::value>>
+bool for_all(cmp_<Op, T> f, const flat_list<T, N>& l) noexcept
+{ return simd::find_first<Op, false>(l.data, N, f.v) == N; }
+
+// find
+
+template <typename T, std::size_t N, typename Fn>
+auto find(Fn f, const flat_list<T, N>& l) -> T {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (f(l.data[i])) { return l.data[i]; }
+    }
+    throw not_found{};
+}
+
+template <cmp_op Op,
+          typename T,
+          std::size_t N,
+          typename = std::enable_if_t<simd::is_simd_type<T>::value>>
+auto find(cmp_<Op, T> f, const flat_list<T, N>& l) -> T {
+    auto i = simd::find_first<Op>(l.data, N, f.v);
+    if (i == N) { throw not_found{}; }
+    return l.data[i];
+}
+
+// find_opt, pointer to the first element satisfying f, nullptr if none
+
+template <typename T, std::size_t N, typename Fn>
+constexpr const T* find_opt(Fn f, const flat_list<T, N>& l) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (f(l.data[i])) { return &l.data[i]; }
+    }
+    return nullptr;
+}
+
+template <cmp_op Op,
+          typename T,
+          std::size_t N,
+          typename = std::enable_if_t<simd::is_simd_type<T>::value>>
+const T* find_opt(cmp_<Op, T> f, const flat_list<T, N>& l) noexcept {
+    auto i = simd::find_first<Op>(l.data, N, f.v);
+    return i == N ? nullptr : &l.data[i];
+}
+
+// at, runtime index
+
+template <typename T, std::size_t N>
+constexpr auto at(const flat_list<T, N>& l, std::size_t i) -> const T& {
+    if (i >= N) { throw not_found{"at"}; }
+    return l.data[i];
+}
+
+template <typename T, std::size_t N>
+constexpr const T* nth_opt(const flat_list<T, N>& l, std::size_t i) noexcept
+{ return i < N ? &l.data[i] : nullptr; }
+
+// zip, one loop over the K arrays. the lists may hold different types but
+// must have the same size. zip_with stores into a default constructed
+// result, simple arithmetic on int, float or double then vectorizes.
+
+template <typename L, typename... Ls>
+struct is_flat_zip_ : all_<is_flat_list<L>::value, is_flat_list<Ls>::value...> {};
+
+template <typename Fn,
+          typename T,
+          std::size_t N,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_flat_zip_<flat_list<T, N>, Ls...>::value>>
+constexpr auto zip_with(Fn f, const flat_list<T, N>& l, const Ls&... ls)
+    -> flat_list<std::decay_t<decltype(f(l.data[0], ls.data[0]...))>, N>
+{
+    static_assert(same_length_<flat_list<T, N>, Ls...>::value, "zip of lists of different lengths");
+    flat_list<std::decay_t<decltype(f(l.data[0], ls.data[0]...))>, N> r{};
+    for (std::size_t i = 0; i < N; ++i) { r.data[i] = f(l.data[i], ls.data[i]...); }
+    return r;
+}
+
+template <typename Fn,
+          typename T,
+          std::size_t N,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_flat_zip_<flat_list<T, N>, Ls...>::value>>
+constexpr void zip_iter(Fn f, const flat_list<T, N>& l, const Ls&... ls) {
+    static_assert(same_length_<flat_list<T, N>, Ls...>::value, "zip of lists of different lengths");
+    for (std::size_t i = 0; i < N; ++i) { f(l.data[i], ls.data[i]...); }
+}
+
+template <typename Fn,
+          typename T,
+          std::size_t N,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_flat_zip_<flat_list<T, N>, Ls...>::value>>
+constexpr bool zip_all(Fn f, const flat_list<T, N>& l, const Ls&... ls) {
+    static_assert(same_length_<flat_list<T, N>, Ls...>::value, "zip of lists of different lengths");
+    for (std::size_t i = 0; i < N; ++i) {
+        if (not f(l.data[i], ls.data[i]...)) { return false; }
+    }
+    return true;
+}
+
+template <typename Fn,
+          typename T,
+          std::size_t N,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_flat_zip_<flat_list<T, N>, Ls...>::value>>
+constexpr bool zip_any(Fn f, const flat_list<T, N>& l, const Ls&... ls) {
+    static_assert(same_length_<flat_list<T, N>, Ls...>::value, "zip of lists of different lengths");
+    for (std::size_t i = 0; i < N; ++i) {
+        if (f(l.data[i], ls.data[i]...)) { return true; }
+    }
+    return false;
+}
+
+// fold_left
+
+template <typename Fn, typename Acc, typename T, std::size_t N>
+constexpr auto fold_left(Fn f, Acc acc, const flat_list<T, N>& l) -> Acc {
+    for (std::size_t i = 0; i < N; ++i) { acc = f(std::move(acc), l.data[i]); }
+    return acc;
+}
+
+// fold_right
+
+template <typename Fn, typename T, std::size_t N, typename Acc>
+constexpr auto fold_right(Fn f, const flat_list<T, N>& l, Acc acc) -> Acc {
+    for (std::size_t i = N; i > 0; --i) { acc = f(l.data[i - 1], std::move(acc)); }
+    return acc;
+}
+
+// reduce p[0..n), n > 0, p is a pointer or anything with operator[]. the
+// range is cut in four contiguous parts reduced side by side, the four
+// chains are independent so their calls overlap, then combined as a tree.
+// only associativity is required.
+template <typename Fn,
+          typename P,
+          typename T = std::decay_t<decltype(std::declval<const P&>()[0])>>
+constexpr auto flat_reduce_(Fn& f, const P& p, std::size_t n) -> T {
+    if (n < 8) {
+        T r = p[0];
+        for (std::size_t i = 1; i < n; ++i) { r = f(r, p[i]); }
+        return r;
+    }
+    auto m = n / 4;
+    T a0 = p[0];
+    T a1 = p[m];
+    T a2 = p[2 * m];
+    T a3 = p[3 * m];
+    for (std::size_t i = 1; i < m; ++i) {
+        a0 = f(a0, p[i]);
+        a1 = f(a1, p[m + i]);
+        a2 = f(a2, p[2 * m + i]);
+        a3 = f(a3, p[3 * m + i]);
+    }
+    for (std::size_t i = 4 * m; i < n; ++i) { a3 = f(a3, p[i]); }
+    return f(f(a0, a1), f(a2, a3));
+}
+
+template <typename Fn, typename T, std::size_t N>
+constexpr auto reduce(Fn f, const flat_list<T, N>& l) -> T
+{ return flat_reduce_(f, l.data, N); }
+
+// conversion from a cons_ list, the list is indexed once by elem_refs_
+// then the array is built in one go from a single pack of indices.
+
+template <typename T, typename R, std::size_t... I>
+constexpr auto to_flat_(const R& r, std::index_sequence<I...>) noexcept
+    -> flat_list<T, sizeof...(I)>
+{ return flat_list<T, sizeof...(I)>{{elem_ref_get_<I>(r)...}}; }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<
+                         std::is_same<
+                             L,
+                             typename list_type_from_size<
+                                 typename L::head_type,
+                                 length<L>::value
+                             >::type
+                         >::value
+                     >>
+constexpr auto to_flat(const L& l) noexcept
+    -> flat_list<typename L::head_type, length<L>::value>
+{ return to_flat_<typename L::head_type>(elem_refs_<0, L>(l), std::make_index_sequence<length<L>::value>{}); }
+
+// conversion to a cons_ list, each node is built in place by the index_<I>
+// constructor from the I-th element of the array, copied once.
+
+template <typename T, std::size_t N>
+struct flat_src_ {
+    template <std::size_t I>
+    constexpr const T& get() const noexcept { return l.data[I]; }
+    const flat_list<T, N>& l;
+};
+
+template <typename T, std::size_t N>
+constexpr auto to_cons(const flat_list<T, N>& l) noexcept
+    -> typename list_type_from_size<T, N>::type
+{ return typename list_type_from_size<T, N>::type(index_<0>{}, flat_src_<T, N>{l}); }
+
+} // l
+
+template <typename T,
+          std::size_t N>
+std::ostream& operator<<(std::ostream& os, const l::flat_list<T, N>& l) {
+    os << "[";
+    for (std::size_t i = 0; i < N; ++i) {
+        os << l.data[i];
+        if (i + 1 != N) { os << ", "; }
+    }
+    os << "]";
+    return os;
+}
+
+#endif // IMM_FLAT_LIST_H
@@ -0,0 +1,352 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_FORMAT_H
+#define IMM_FORMAT_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <vlist.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <unistd.h>
+
+namespace l {
+
+// text rendering of lists without iostream. output goes to a caller
+// provided buffer, when full the buffer is either flushed to a file
+// descriptor with write(2) or the output is truncated. the text is the
+// one of operator<< on a stream with the default flags, bool as 1 / 0 and
+// the char types as characters. tuples and nil, which have no operator<<,
+// are rendered as (a, b) and [].
+class format_sink {
+public:
+    // no file descriptor, the output is truncated to cap bytes
+    format_sink(char* buf, std::size_t cap) noexcept
+    : buf_(buf), cap_(cap) {}
+
+    // the buffer is written to fd each time it is full and on flush
+    format_sink(char* buf, std::size_t cap, int fd) noexcept
+    : buf_(buf), cap_(cap), fd_(fd) {}
+
+    format_sink(const format_sink&) = delete;
+    format_sink& operator=(const format_sink&) = delete;
+
+    ~format_sink() {
+        if (fd_ >= 0 && len_ != 0) {
+            try { flush(); } catch (...) {}
+        }
+    }
+
+    void put(char c) {
+        total_ += 1;
+        if (len_ == cap_) {
+            if (fd_ < 0 || cap_ == 0) { truncated_ = true; return; }
+            flush();
+        }
+        buf_[len_++] = c;
+    }
+
+    void write(const char* p, std::size_t n) {
+        total_ += n;
+        while (n != 0) {
+            if (len_ == cap_) {
+                if (fd_ < 0 || cap_ == 0) { truncated_ = true; return; }
+                flush();
+            }
+            auto k = n < cap_ - len_ ? n : cap_ - len_;
+            std::memcpy(buf_ + len_, p, k);
+            len_ += k;
+            p += k;
+            n -= k;
+        }
+    }
+
+    // write the buffer to the file descriptor, nothing without one
+    void flush() {
+        if (fd_ < 0) { return; }
+        std::size_t done = 0;
+        while (done < len_) {
+            auto r = ::write(fd_, buf_ + done, len_ - done);
+            if (r < 0) {
+                if (errno == EINTR) { continue; }
+                throw std::system_error(errno, std::generic_category(), "write");
+            }
+            done += static_cast<std::size_t>(r);
+        }
+        len_ = 0;
+    }
+
+    // bytes currently in the buffer
+    std::size_t size() const noexcept { return len_; }
+    // bytes produced so far, including the flushed and truncated ones
+    std::size_t total() const noexcept { return total_; }
+    bool truncated() const noexcept { return truncated_; }
+
+private:
+    char* buf_;
+    std::size_t cap_;
+    int fd_ = -1;
+    std::size_t len_ = 0;
+    std::size_t total_ = 0;
+    bool truncated_ = false;
+};
+
+// integers, two digits at a time from the end. std::to_chars is c++17.
+
+static constexpr char format_digits_[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+inline char* format_uint_(char* end, std::uint64_t v) noexcept {
+    while (v >= 100) {
+        auto d = static_cast<std::size_t>(v % 100) * 2;
+        v /= 100;
+        *--end = format_digits_[d + 1];
+        *--end = format_digits_[d];
+    }
+    if (v >= 10) {
+        auto d = static_cast<std::size_t>(v) * 2;
+        *--end = format_digits_[d + 1];
+        *--end = format_digits_[d];
+    } else {
+        *--end = static_cast<char>('0' + v);
+    }
+    return end;
+}
+
+// types rendered by the overloads below, anything else goes through its
+// operator<<.
+
+template <typename T>
+struct format_native_ : std::integral_constant<bool,
+    std::is_arithmetic<T>::value ||
+    std::is_same<T, std::string>::value ||
+    std::is_same<T, const char*>::value ||
+    std::is_same<T, char*>::value> {};
+template <>
+struct format_native_<nil_t> : std::true_type {};
+template <typename... Ts>
+struct format_native_<std::tuple<Ts...>> : std::true_type {};
+template <typename Head, typename Tail>
+struct format_native_<cons_<Head, Tail>> : std::true_type {};
+template <typename T, std::size_t N>
+struct format_native_<flat_list<T, N>> : std::true_type {};
+template <typename... Ts>
+struct format_native_<vlist<Ts...>> : std::true_type {};
+
+// declared first so nested lists and tuples find every overload
+
+// the char types are characters for operator<<, not integers
+template <typename T>
+struct format_char_ : std::integral_constant<bool,
+    std::is_same<T, char>::value ||
+    std::is_same<T, signed char>::value ||
+    std::is_same<T, unsigned char>::value> {};
+
+inline void format_(format_sink& s, bool v);
+inline void format_(format_sink& s, char v);
+inline void format_(format_sink& s, signed char v);
+inline void format_(format_sink& s, unsigned char v);
+template <typename T,
+          typename = std::enable_if_t<std::is_integral<T>::value>,
+          typename = std::enable_if_t<!std::is_same<T, bool>::value && !format_char_<T>::value>>
+void format_(format_sink& s, T v);
+inline void format_(format_sink& s, double v);
+inline void format_(format_sink& s, float v);
+inline void format_(format_sink& s, long double v);
+inline void format_(format_sink& s, const char* v);
+inline void format_(format_sink& s, const std::string& v);
+inline void format_(format_sink& s, nil_t);
+template <typename... Ts>
+void format_(format_sink& s, const std::tuple<Ts...>& v);
+template <typename Head, typename Tail>
+void format_(format_sink& s, const cons_<Head, Tail>& v);
+template <typename T, std::size_t N>
+void format_(format_sink& s, const flat_list<T, N>& v);
+template <typename... Ts>
+void format_(format_sink& s, const vlist<Ts...>& v);
+template <typename T,
+          typename = std::enable_if_t<!format_native_<T>::value>,
+          typename = void,
+          typename = void>
+void format_(format_sink& s, const T& v);
+
+// scalars
+
+inline void format_(format_sink& s, bool v)
+{ s.put(v ? '1' : '0'); }
+
+inline void format_(format_sink& s, char v)
+{ s.put(v); }
+
+inline void format_(format_sink& s, signed char v)
+{ s.put(static_cast<char>(v)); }
+
+inline void format_(format_sink& s, unsigned char v)
+{ s.put(static_cast<char>(v)); }
+
+template <typename T, typename, typename>
+void format_(format_sink& s, T v) {
+    char tmp[24];
+    auto end = tmp + sizeof(tmp);
+    auto neg = v < T(0);
+    // negated as unsigned so the minimum value does not overflow
+    auto u = static_cast<std::uint64_t>(v);
+    if (neg) { u = std::uint64_t(0) - u; }
+    auto begin = format_uint_(end, u);
+    if (neg) { *--begin = '-'; }
+    s.write(begin, static_cast<std::size_t>(end - begin));
+}
+
+// same output as the default ostream precision
+inline void format_(format_sink& s, double v) {
+    char tmp[32];
+    auto n = std::snprintf(tmp, sizeof(tmp), "%g", v);
+    s.write(tmp, static_cast<std::size_t>(n));
+}
+
+inline void format_(format_sink& s, float v)
+{ format_(s, static_cast<double>(v)); }
+
+inline void format_(format_sink& s, long double v) {
+    char tmp[64];
+    auto n = std::snprintf(tmp, sizeof(tmp), "%Lg", v);
+    s.write(tmp, static_cast<std::size_t>(n));
+}
+
+inline void format_(format_sink& s, const char* v)
+{ s.write(v, std::strlen(v)); }
+
+inline void format_(format_sink& s, const std::string& v)
+{ s.write(v.data(), v.size()); }
+
+// tuples, (a, b)
+
+template <typename... Ts, std::size_t... I>
+void format_tuple_(format_sink& s, const std::tuple<Ts...>& v, std::index_sequence<I...>) {
+    using expand = int[];
+    (void)expand{0, (I == 0 ? void() : s.write(", ", 2), format_(s, std::get<I>(v)), 0)...};
+}
+
+template <typename... Ts>
+void format_(format_sink& s, const std::tuple<Ts...>& v) {
+    s.put('(');
+    format_tuple_(s, v, std::index_sequence_for<Ts...>{});
+    s.put(')');
+}
+
+// lists, [a, b, c], each element is rendered with its own type
+
+inline void format_(format_sink& s, nil_t)
+{ s.write("[]", 2); }
+
+inline void format_cons_(format_sink&, nil_t) {}
+
+template <typename Head, typename Tail>
+void format_cons_(format_sink& s, const cons_<Head, Tail>& v) {
+    s.write(", ", 2);
+    format_(s, v.h);
+    format_cons_(s, v.t);
+}
+
+template <typename Head, typename Tail>
+void format_(format_sink& s, const cons_<Head, Tail>& v) {
+    s.put('[');
+    format_(s, v.h);
+    format_cons_(s, v.t);
+    s.put(']');
+}
+
+template <typename T, std::size_t N>
+void format_(format_sink& s, const flat_list<T, N>& v) {
+    s.put('[');
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i != 0) { s.write(", ", 2); }
+        format_(s, v.data[i]);
+    }
+    s.put(']');
+}
+
+template <typename... Ts>
+void format_(format_sink& s, const vlist<Ts...>& v) {
+    s.put('[');
+    iteri([&](std::size_t i, const auto& e) {
+        if (i != 0) { s.write(", ", 2); }
+        format_(s, e);
+    }, v);
+    s.put(']');
+}
+
+// anything else, slow path through its operator<<
+template <typename T, typename, typename, typename>
+void format_(format_sink& s, const T& v) {
+    std::ostringstream os;
+    os << v;
+    auto str = os.str();
+    s.write(str.data(), str.size());
+}
+
+// render v into the sink
+template <typename T>
+void format(format_sink& s, const T& v)
+{ format_(s, v); }
+
+// render v into buf, at most cap bytes are written and nothing is null
+// terminated. returns the full length of the text, larger than cap when
+// it was truncated, like snprintf.
+template <typename T>
+std::size_t format_to(char* buf, std::size_t cap, const T& v) {
+    format_sink s(buf, cap);
+    format_(s, v);
+    return s.total();
+}
+
+// render v directly to a file descriptor through a stack buffer
+template <typename T>
+void format_fd(int fd, const T& v) {
+    char buf[4096];
+    format_sink s(buf, sizeof(buf), fd);
+    format_(s, v);
+    s.flush();
+}
+
+template <typename T>
+std::string to_string(const T& v) {
+    char buf[256];
+    auto n = format_to(buf, sizeof(buf), v);
+    if (n <= sizeof(buf)) { return std::string(buf, n); }
+    std::string r(n, '\0');
+    format_to(&r[0], n, v);
+    return r;
+}
+
+} // l
+
+#endif // IMM_FORMAT_H
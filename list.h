@@ -26,6 +26,10 @@
 #include <type_traits>
 #include <functional>
 #include <iostream>
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <stats.h>
 
 namespace l {
 
@@ -45,13 +49,115 @@ public:
 struct nil_t {};
 struct empty_t {};
 
+// tag of the constructor building a list from the I-th element of a source
+template <std::size_t I>
+struct index_ {};
+
+template <typename T>
+struct is_index_ : std::false_type {};
+template <std::size_t I>
+struct is_index_<index_<I>> : std::true_type {};
+
+// tag of the constructor building a list from f applied to the heads of lists
+struct zip_tag_ {};
+
+// tag of the constructor building a list from the elements of a list then
+// another list as the last tail
+struct append_tag_ {};
+
+// tag of the constructor building a list from the elements of a list in
+// reverse order then another list as the last tail
+struct rev_tag_ {};
+
+// first argument selecting one of the tagged constructors
+template <typename T>
+struct is_ctor_tag_ : is_index_<T> {};
+template <>
+struct is_ctor_tag_<zip_tag_> : std::true_type {};
+template <>
+struct is_ctor_tag_<append_tag_> : std::true_type {};
+template <>
+struct is_ctor_tag_<rev_tag_> : std::true_type {};
+
 template <typename Head, typename Tail>
 struct cons_ {
     using head_type = Head;
     using tail_type = Tail;
     cons_() = delete;
-    constexpr explicit cons_(const Head& h, const Tail& t)
-    : h(h), t(t) {}
+    // (h, t) builds from a head and a tail, (h, e1, ..., en) builds the
+    // tail in place from the next elements so each one is forwarded once.
+    template <typename H,
+              typename... Ts,
+              typename = std::enable_if_t<!is_ctor_tag_<std::decay_t<H>>::value>,
+              typename = std::enable_if_t<
+                             sizeof...(Ts) != 0 ||
+                             (std::is_same<Tail, nil_t>::value &&
+                              !std::is_same<std::decay_t<H>, cons_>::value)
+                         >>
+    constexpr explicit cons_(H&& h, Ts&&... ts)
+    : h(static_cast<H&&>(h)), t(static_cast<Ts&&>(ts)...) {}
+    // (index_<I>, src) builds from src.get<I>(), src.get<I + 1>(), ... one
+    // node per instantiation instead of a pack of all the elements.
+    template <std::size_t I,
+              typename Src,
+              typename T = Tail,
+              typename = std::enable_if_t<!std::is_same<T, nil_t>::value>>
+    constexpr cons_(index_<I>, const Src& src)
+    : h(src.template get<I>()), t(index_<I + 1>{}, src) {}
+    template <std::size_t I,
+              typename Src,
+              typename T = Tail,
+              typename = std::enable_if_t<std::is_same<T, nil_t>::value>,
+              typename = void>
+    constexpr cons_(index_<I>, const Src& src)
+    : h(src.template get<I>()), t() {}
+    // the constructors below walk the source lists node by node, one
+    // constructor per node is the only instantiation for each element.
+    // static_cast<Ls&&> is std::forward, without the instantiation of
+    // std::forward for every node type.
+    //
+    // (zip_tag_, f, l1, ..., lk) builds from f(l1.h, ..., lk.h) then the
+    // tails, the results are constructed in place in a single pass. the
+    // elements of the rvalue lists are moved to f.
+    template <typename Fn,
+              typename... Ls,
+              typename T = Tail,
+              typename = std::enable_if_t<!std::is_same<T, nil_t>::value>>
+    constexpr cons_(zip_tag_, Fn& f, Ls&&... ls)
+    : h(f(static_cast<Ls&&>(ls).h...)), t(zip_tag_{}, f, static_cast<Ls&&>(ls).t...) {}
+    template <typename Fn,
+              typename... Ls,
+              typename T = Tail,
+              typename = std::enable_if_t<std::is_same<T, nil_t>::value>,
+              typename = void>
+    constexpr cons_(zip_tag_, Fn& f, Ls&&... ls)
+    : h(f(static_cast<Ls&&>(ls).h...)), t() {}
+    // (append_tag_, l1, l2) copies (or moves) the elements of l1, the last
+    // node of l1 is followed by a copy (or a move) of l2.
+    template <typename L1,
+              typename L2,
+              typename = std::enable_if_t<!std::is_same<typename std::decay_t<L1>::tail_type, nil_t>::value>>
+    constexpr cons_(append_tag_, L1&& l1, L2&& l2)
+    : h(static_cast<L1&&>(l1).h), t(append_tag_{}, static_cast<L1&&>(l1).t, static_cast<L2&&>(l2)) {}
+    template <typename L1,
+              typename L2,
+              typename = std::enable_if_t<std::is_same<typename std::decay_t<L1>::tail_type, nil_t>::value>,
+              typename = void>
+    constexpr cons_(append_tag_, L1&& l1, L2&& l2)
+    : h(static_cast<L1&&>(l1).h), t(static_cast<L2&&>(l2)) {}
+    // (rev_tag_, frame, l2) builds from the element of the frame then the
+    // ones of the previous frames, the last node is followed by l2.
+    template <typename Frame,
+              typename L2,
+              typename = std::enable_if_t<!Frame::first>>
+    constexpr cons_(rev_tag_, const Frame& f, L2&& l2)
+    : h(static_cast<typename Frame::elem_type>(f.e)), t(rev_tag_{}, f.prev, static_cast<L2&&>(l2)) {}
+    template <typename Frame,
+              typename L2,
+              typename = std::enable_if_t<Frame::first>,
+              typename = void>
+    constexpr cons_(rev_tag_, const Frame& f, L2&& l2)
+    : h(static_cast<typename Frame::elem_type>(f.e)), t(static_cast<L2&&>(l2)) {}
     Head h;
     Tail t;
 };
@@ -133,6 +239,74 @@ struct list_type_from_size<Head, 0> {
     using type = cons_<Head, nil_t>;
 };
 
+// make a new list type from a list of types and the last tail
+
+template <typename Tail, typename... Ts>
+struct list_type_from_types_ {
+    using type = Tail;
+};
+
+template <typename Tail, typename T, typename... Ts>
+struct list_type_from_types_<Tail, T, Ts...> {
+    using type = cons_<T, typename list_type_from_types_<Tail, Ts...>::type>;
+};
+
+template <typename... Ts>
+struct list_type_from_types {
+    using type = typename list_type_from_types_<nil_t, Ts...>::type;
+};
+
+// head and tail of a forwarded list, rvalues when the list is one
+
+template <typename L>
+using head_of_ = decltype((std::declval<L>().h));
+
+template <typename L>
+using tail_of_ = decltype((std::declval<L>().t));
+
+// type of the list of the f(l1.h, ..., lk.h), built by the zip_tag_
+// constructor. the lists are forwarding references.
+
+template <bool End, typename Fn, typename... Ls>
+struct zip_type_ {
+    using type = nil_t;
+};
+
+template <typename Fn, typename L, typename... Ls>
+struct zip_type_<false, Fn, L, Ls...> {
+    using type = cons_<std::decay_t<decltype(std::declval<Fn&>()(std::declval<head_of_<L>>(),
+                                                                std::declval<head_of_<Ls>>()...))>,
+                       typename zip_type_<std::is_same<std::decay_t<tail_of_<L>>, nil_t>::value,
+                                          Fn, tail_of_<L>, tail_of_<Ls>...>::type>;
+};
+
+// type of l1 reversed followed by l2
+
+template <typename L1, typename L2>
+struct rev_type_ {
+    using type = L2;
+};
+
+template <typename H, typename T, typename L2>
+struct rev_type_<cons_<H, T>, L2> {
+    using type = typename rev_type_<T, cons_<H, L2>>::type;
+};
+
+// type of l1 followed by l2, built by the append_tag_ constructor
+
+template <typename L1, typename L2>
+struct append_type_;
+
+template <typename H, typename T, typename L2>
+struct append_type_<cons_<H, T>, L2> {
+    using type = cons_<H, typename append_type_<T, L2>::type>;
+};
+
+template <typename L2>
+struct append_type_<nil_t, L2> {
+    using type = L2;
+};
+
 // nth
 
 template <std::size_t N,
@@ -157,35 +331,25 @@ constexpr auto nth(const L& l) noexcept -> typename L::head_type
 template <typename L,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>>
-constexpr void iter(Fn f, const L& l) {
+constexpr void iter_(Fn f, const L& l) {
+    IMM_STATS_HOOK(step_(stats::op::iter));
     f(l.h);
-    iter(f, l.t);
+    iter_(f, l.t);
 }
 
 template <typename Fn>
-constexpr void iter(Fn f, const nil_t) {}
-
-// iter2
+constexpr void iter_(Fn f, const nil_t) {}
 
-template <typename L1,
-          typename L2,
+template <typename L,
           typename Fn,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
-          typename = std::enable_if_t<
-                         std::is_same<
-                             typename L1::head_type,
-                             typename L2::head_type
-                         >::value
-                     >>
-constexpr void iter2(Fn f, const L1& l1, const L2& l2) {
-    f(l1.h, l2.h);
-    iter2(f, l1.t, l2.t);
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr void iter(Fn f, const L& l) {
+    IMM_STATS_HOOK(query_(stats::op::iter));
+    iter_(f, l);
 }
 
 template <typename Fn>
-constexpr void iter2(Fn, nil_t, nil_t) {}
-
+constexpr void iter(Fn f, const nil_t) {}
 
 // iteri
 
@@ -194,6 +358,7 @@ template <std::size_t N,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>>
 constexpr void iteri_(Fn f, const L& l) {
+    IMM_STATS_HOOK(step_(stats::op::iter));
     f(N, l.h);
     iteri_<N+1>(f, l.t);
 }
@@ -205,190 +370,352 @@ template <typename L,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>>
 constexpr void iteri(Fn f, const L& l) {
+    IMM_STATS_HOOK(query_(stats::op::iter));
     iteri_<0>(f, l);
 }
 
-// rev list
+// sublist starting at the K-th element, halved at each step so the
+// recursion depth is log(K)
 
-// implementation rev
-template <typename From,
-          typename To>
-constexpr auto rev_(From f, To t) noexcept
-    -> decltype(rev_(f.t, l::cons_<decltype(f.h), To>(f.h, t)))
-{ return rev_(f.t, l::cons_<decltype(f.h), To>(f.h, t)); }
+template <std::size_t K, typename L>
+struct drop_ {
+    using first = drop_<K / 2, L>;
+    using second = drop_<K - K / 2, typename first::type>;
+    using type = typename second::type;
+    static constexpr const type& get(const L& l) noexcept
+    { return second::get(first::get(l)); }
+};
 
-template <typename Head,
-          typename To>
-constexpr cons_<Head, To> rev_(const cons_<Head, nil_t>& f, To t) noexcept
-{ return cons_<Head, To>(f.h, t); }
+template <typename L>
+struct drop_<0, L> {
+    using type = L;
+    static constexpr const type& get(const L& l) noexcept { return l; }
+};
 
-// rev list of more than one element
-template <typename L,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>,
-          typename = std::enable_if_t<l::is_not_nil_t<L, L>::value>>
-constexpr L rev(const L& l) noexcept
-{ return rev_(l.t, l::cons_<decltype(l.h), l::nil_t>(l.h, l::nil_t{})); }
+template <typename L>
+struct drop_<1, L> {
+    using type = typename L::tail_type;
+    static constexpr const type& get(const L& l) noexcept { return l.t; }
+};
 
-// explictly one element
-template <typename Head>
-constexpr cons_<Head, nil_t> rev(const cons_<Head, nil_t>& l) noexcept
-{ return l; }
+// pointers to the elements of a list, taken by a single walk down the list.
+// the pointer to the I-th element is kept in an elem_ref_<I, T> base
+// selected by overload resolution, so the elements are then read from a
+// pack of indices without any recursion per element.
 
-// map
-template <typename Fn,
+template <std::size_t I, typename T>
+struct elem_ref_ {
+    const T* p;
+};
+
+template <std::size_t I, typename L>
+struct elem_refs_;
+
+template <std::size_t I>
+struct elem_refs_<I, nil_t> {
+    constexpr explicit elem_refs_(nil_t) noexcept {}
+};
+
+template <std::size_t I, typename Head, typename Tail>
+struct elem_refs_<I, cons_<Head, Tail>> : elem_ref_<I, Head>, elem_refs_<I + 1, Tail> {
+    constexpr explicit elem_refs_(const cons_<Head, Tail>& l) noexcept
+    : elem_ref_<I, Head>{&l.h}, elem_refs_<I + 1, Tail>(l.t) {}
+};
+
+template <std::size_t I, typename T>
+constexpr const T& elem_ref_get_(const elem_ref_<I, T>& r) noexcept
+{ return *r.p; }
+
+template <std::size_t I, typename T>
+T elem_ref_type_(const elem_ref_<I, T>&);
+
+template <std::size_t I, typename R>
+using elem_ref_t_ = decltype(elem_ref_type_<I>(std::declval<const R&>()));
+
+// rev list
+
+// an element of l1, on the stack of the walk down l1 and linked to the
+// frame of the previous element. a frame is named by the node of the
+// reversed list built from it, Out, so the constructor of that node does not
+// spell another list type in its mangled name. To is the type of l2, the
+// frame of the first element of l1 builds the node followed by l2.
+struct rev_end_ {};
+
+template <typename Out, typename To, bool Move>
+struct rev_frame_ {
+    using elem_type = std::conditional_t<Move,
+                                         typename Out::head_type&&,
+                                         const typename Out::head_type&>;
+    static constexpr bool first = std::is_same<typename Out::tail_type, To>::value;
+    using prev_type = std::conditional_t<first, rev_end_, rev_frame_<typename Out::tail_type, To, Move>>;
+    elem_type e;
+    const prev_type& prev;
+};
+
+// walk down l1, one frame per element, then build the reversed list R from
+// the last frame. each element is copied (or moved when its list is an
+// rvalue) exactly once.
+template <typename R,
+          typename To,
+          typename Last>
+constexpr R rev_walk_(nil_t, To&& t, const Last& last)
+{ return R(rev_tag_{}, last, static_cast<To&&>(t)); }
+
+template <typename R,
           typename From,
-          typename To>
-constexpr auto map_(Fn f, From fl, To t) noexcept
-    -> decltype(map_(f, fl.t, cons_<decltype(f(fl.h)), To>(f(fl.h), t)))
-{ return map_(f, fl.t, l::cons_<decltype(f(fl.h)), To>(f(fl.h), t)); }
+          typename To,
+          typename Prev,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<From>>::value>>
+constexpr R rev_walk_(From&& f, To&& t, const Prev& prev)
+{
+    using frame = rev_frame_<typename drop_<length<std::decay_t<From>>::value - 1, R>::type,
+                             std::decay_t<To>,
+                             !std::is_lvalue_reference<From>::value>;
+    return rev_walk_<R>(static_cast<From&&>(f).t, static_cast<To&&>(t),
+                        frame{static_cast<From&&>(f).h, prev});
+}
 
-template <typename Fn,
-          typename Head,
+template <typename From,
           typename To>
-constexpr auto map_(Fn f, const cons_<Head, nil_t>& l, To t) noexcept -> cons_<decltype(f(l.h)), To>
-{ return cons_<decltype(f(l.h)), To>(f(l.h), t); }
+constexpr auto rev_(From&& f, To&& t) noexcept
+    -> typename rev_type_<std::decay_t<From>, std::decay_t<To>>::type
+{
+    IMM_STATS_HOOK(build_(stats::op::rev, length<std::decay_t<From>>::value,
+                          std::is_lvalue_reference<From>::value ? length<std::decay_t<From>>::value : 0));
+    IMM_STATS_HOOK(tail_(stats::op::rev, length<std::decay_t<To>>::value,
+                         std::is_lvalue_reference<To>::value));
+    return rev_walk_<typename rev_type_<std::decay_t<From>, std::decay_t<To>>::type>(
+        std::forward<From>(f), std::forward<To>(t), rev_end_{});
+}
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L>>::value>>
+constexpr auto rev(L&& l) noexcept
+{ return rev_(std::forward<L>(l), l::nil_t{}); }
+
+// map
 
-// map list of more than one element
+// the results of f are constructed in place by the zip_tag_ constructor,
+// the elements of an rvalue list are moved to f.
 template <typename Fn,
           typename L,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>,
-          typename = std::enable_if_t<l::is_not_nil_t<L, L>::value>>
-constexpr auto map(Fn f, const L& l) noexcept
-    -> decltype(map_(f, l.t, cons_<decltype(f(l.h)), nil_t>(f(l.h), l::nil_t{})))
-{ return map_(f, l.t, l::cons_<decltype(f(l.h)), l::nil_t>(f(l.h), l::nil_t{})); }
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L>>::value>>
+constexpr auto map(Fn f, L&& l) noexcept -> typename zip_type_<false, Fn, L&&>::type
+{
+    IMM_STATS_HOOK(build_in_place_(stats::op::map, length<std::decay_t<L>>::value));
+    IMM_STATS_HOOK(callback_(stats::op::map, length<std::decay_t<L>>::value));
+    return typename zip_type_<false, Fn, L&&>::type(zip_tag_{}, f, std::forward<L>(l));
+}
 
-// explictly one element
-template <typename Fn,
-          typename Head>
-constexpr auto map(Fn f, const cons_<Head, nil_t>& l) noexcept -> cons_<decltype(f(l.h)), nil_t>
-{ return cons_<decltype(f(l.h)), nil_t>(f(l.h), nil_t{}); }
 
+// zip, K lists of the same length walked in a single pass. f is called with
+// the i-th element of every list: zip_with builds the list of the results,
+// zip_iter only calls f, zip_all and zip_any stop at the first false / true.
+// the lengths are checked at compile time.
+
+template <bool... Bs>
+struct bools_ {};
+
+// all true if the list of booleans is equal to its rotation starting by true
+template <bool... Bs>
+struct all_ : std::is_same<bools_<true, Bs...>, bools_<Bs..., true>> {};
 
+template <typename L, typename... Ls>
+struct same_length_ : all_<(length<Ls>::value == length<L>::value)...> {};
 
+template <typename L, typename... Ls>
+struct is_zip_ : all_<is_imm_list<L>::value || std::is_same<L, nil_t>::value,
+                      (is_imm_list<Ls>::value || std::is_same<Ls, nil_t>::value)...> {};
+
+template <typename Fn, typename... Ls>
+constexpr void zip_iter_(Fn&, nil_t, const Ls&...) {}
+
+template <typename Fn, typename H, typename T, typename... Ls>
+constexpr void zip_iter_(Fn& f, const cons_<H, T>& l, const Ls&... ls) {
+    IMM_STATS_HOOK(step_(stats::op::zip));
+    f(l.h, ls.h...);
+    zip_iter_(f, l.t, ls.t...);
+}
+
+template <typename Fn, typename... Ls>
+constexpr bool zip_all_(Fn&, nil_t, const Ls&...)
+{ return true; }
+
+template <typename Fn, typename H, typename T, typename... Ls>
+constexpr bool zip_all_(Fn& f, const cons_<H, T>& l, const Ls&... ls) {
+    IMM_STATS_HOOK(step_(stats::op::zip));
+    return f(l.h, ls.h...) && zip_all_(f, l.t, ls.t...);
+}
+
+template <typename Fn, typename... Ls>
+constexpr bool zip_any_(Fn&, nil_t, const Ls&...)
+{ return false; }
+
+template <typename Fn, typename H, typename T, typename... Ls>
+constexpr bool zip_any_(Fn& f, const cons_<H, T>& l, const Ls&... ls) {
+    IMM_STATS_HOOK(step_(stats::op::zip));
+    return f(l.h, ls.h...) || zip_any_(f, l.t, ls.t...);
+}
 
-// map2
 template <typename Fn,
-          typename From1,
-          typename From2,
-          typename To>
-constexpr auto map2_(Fn f, const From1& f1, const From2& f2, const To& t) noexcept
-    -> decltype(map2_(f, f1.t, f2.t, cons_<decltype(f(f1.h, f2.h)), To>(f(f1.h, f2.h), t)))
-{ return map2_(f, f1.t, f2.t, l::cons_<decltype(f(f1.h, f2.h)), To>(f(f1.h. f2.h), t)); }
+          typename L,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<l::is_zip_<L, Ls...>::value>>
+constexpr auto zip_with(Fn f, const L& l, const Ls&... ls)
+    -> typename zip_type_<false, Fn, const L&, const Ls&...>::type
+{
+    static_assert(same_length_<L, Ls...>::value, "zip of lists of different lengths");
+    IMM_STATS_HOOK(build_in_place_(stats::op::zip, length<L>::value));
+    IMM_STATS_HOOK(callback_(stats::op::zip, length<L>::value));
+    return typename zip_type_<false, Fn, const L&, const Ls&...>::type(zip_tag_{}, f, l, ls...);
+}
 
 template <typename Fn,
-          typename Head1,
-          typename Head2,
-          typename To>
-constexpr auto map2_(Fn f,
-                     const cons_<Head1, nil_t>& l1,
-                     const cons_<Head2, nil_t>& l2,
-                     const To& t) noexcept
-    -> cons_<decltype(f(l1.h, l2.h)), To>
-{ return cons_<decltype(f(l1.h, l2.h)), To>(f(l1.h, l2.h), t); }
-
-// map list of more than one element
+          typename... Ls,
+          typename = std::enable_if_t<l::is_zip_<nil_t, Ls...>::value>>
+constexpr nil_t zip_with(Fn, nil_t, const Ls&...) {
+    static_assert(same_length_<nil_t, Ls...>::value, "zip of lists of different lengths");
+    return nil_t{};
+}
+
 template <typename Fn,
-          typename L1,
-          typename L2,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
-          typename = std::enable_if_t<l::is_not_nil_t<L1, L2>::value>,
-          typename = std::enable_if_t<l::length<L1>::value == l::length<L2>::value>>
-constexpr auto map2(Fn f, const L1& l1, const L2& l2) noexcept
-    -> decltype(map2_(f, l1.t, l2.t, cons_<decltype(f(l1.h, l2.h)), nil_t>(f(l1.h, l2.h), l::nil_t{})))
-{ return map2_(f, l1.t, l2.t, cons_<decltype(f(l1.h, l2.h)), nil_t>(f(l1.h, l2.h), nil_t{})); }
-
-// explictly one element
+          typename L,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_zip_<L, Ls...>::value>>
+constexpr void zip_iter(Fn f, const L& l, const Ls&... ls) {
+    static_assert(same_length_<L, Ls...>::value, "zip of lists of different lengths");
+    IMM_STATS_HOOK(query_(stats::op::zip));
+    zip_iter_(f, l, ls...);
+}
+
+template <typename Fn,
+          typename L,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_zip_<L, Ls...>::value>>
+constexpr bool zip_all(Fn f, const L& l, const Ls&... ls) {
+    static_assert(same_length_<L, Ls...>::value, "zip of lists of different lengths");
+    IMM_STATS_HOOK(query_(stats::op::zip));
+    return zip_all_(f, l, ls...);
+}
+
 template <typename Fn,
-          typename Head1,
-          typename Head2>
-constexpr auto map2(Fn f, const cons_<Head1, nil_t>& l1, const cons_<Head2, nil_t>& l2) noexcept
-    -> cons_<decltype(f(l1.h, l2.h)), nil_t>
-{ return cons_<decltype(f(l1.h, l2.h)), nil_t>(f(l1.h, l2.h), nil_t{}); }
+          typename L,
+          typename... Ls,
+          typename = std::enable_if_t<l::is_zip_<L, Ls...>::value>>
+constexpr bool zip_any(Fn f, const L& l, const Ls&... ls) {
+    static_assert(same_length_<L, Ls...>::value, "zip of lists of different lengths");
+    IMM_STATS_HOOK(query_(stats::op::zip));
+    return zip_any_(f, l, ls...);
+}
+
+// the two lists versions
+
+template <typename Fn, typename L1, typename L2>
+constexpr auto iter2(Fn f, const L1& l1, const L2& l2)
+    -> decltype(zip_iter(f, l1, l2))
+{ return zip_iter(f, l1, l2); }
+
+template <typename Fn, typename L1, typename L2>
+constexpr auto map2(Fn f, const L1& l1, const L2& l2)
+    -> decltype(zip_with(f, l1, l2))
+{ return zip_with(f, l1, l2); }
+
+template <typename Fn, typename L1, typename L2>
+constexpr auto for_all2(Fn f, const L1& l1, const L2& l2)
+    -> decltype(zip_all(f, l1, l2))
+{ return zip_all(f, l1, l2); }
+
+template <typename Fn, typename L1, typename L2>
+constexpr auto exists2(Fn f, const L1& l1, const L2& l2)
+    -> decltype(zip_any(f, l1, l2))
+{ return zip_any(f, l1, l2); }
 
 // mapi
-template <std::size_t N,
-          typename Fn,
-          typename From,
-          typename To>
-constexpr auto mapi_(Fn f, From fl, To t) noexcept
-    // FIXME: not able to delcare this type.
-    // -> decltype(mapi_<N+1>(f, fl.t, cons_<decltype(f(N, fl.h)), To>(f(N, fl.h), t)))
-{ return mapi_<N+1>(f, fl.t, cons_<decltype(f(N, fl.h)), To>(f(N, fl.h), t)); }
 
-template <std::size_t N,
-          typename Fn,
-          typename Head,
-          typename To>
-constexpr auto mapi_(Fn f, const cons_<Head, nil_t>& l, To t) noexcept
-    -> cons_<decltype(f(N, l.h)), To>
-{ return cons_<decltype(f(N, l.h)), To>(f(N, l.h), t); }
+// f with the index of the element, the heads are constructed before the
+// tails so the elements are visited in order.
+template <typename Fn>
+struct mapi_fn_ {
+    template <typename E>
+    constexpr auto operator()(E&& e) -> decltype(std::declval<Fn&>()(std::size_t{}, std::forward<E>(e)))
+    { return f(i++, std::forward<E>(e)); }
+    Fn& f;
+    std::size_t i;
+};
 
-// mapi list of more than one element
 template <typename Fn,
           typename L,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>,
-          typename = std::enable_if_t<l::is_not_nil_t<L, L>::value>>
-constexpr auto mapi(Fn f, const L& l) noexcept
-    -> decltype(mapi_<1>(f, l.t, cons_<decltype(f(0, l.h)), nil_t>(f(0, l.h), l::nil_t{})))
-{ return mapi_<1>(f, l.t, l::cons_<decltype(f(0, l.h)), l::nil_t>(f(0, l.h), l::nil_t{})); }
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L>>::value>>
+constexpr auto mapi(Fn f, L&& l) noexcept -> typename zip_type_<false, mapi_fn_<Fn>, L&&>::type
+{
+    IMM_STATS_HOOK(build_in_place_(stats::op::mapi, length<std::decay_t<L>>::value));
+    IMM_STATS_HOOK(callback_(stats::op::mapi, length<std::decay_t<L>>::value));
+    mapi_fn_<Fn> fi{f, 0};
+    return typename zip_type_<false, mapi_fn_<Fn>, L&&>::type(zip_tag_{}, fi, std::forward<L>(l));
+}
 
-// explictly one element
-template <typename Fn, typename Head>
-constexpr auto mapi(Fn f, const cons_<Head, nil_t>& l) noexcept
-    -> cons_<decltype(f(0, l.h)), nil_t>
-{ return cons_<decltype(f(0, l.h)), nil_t>(f(0, l.h), nil_t{}); }
+// append
 
+// the elements of l1 are copied (or moved) node by node by the append_tag_
+// constructor, the last one is followed by l2.
 template <typename L1,
           typename L2,
-          typename = std::enable_if_t<length<L1>::value >= 1>>
-constexpr auto append_(const L1& l1, const L2& l2) noexcept
-    -> decltype(append_(l1.t, cons_<decltype(l1.h), L2>(l1.h, l2)))
-{ return append_(l1.t, cons_<decltype(l1.h), L2>(l1.h, l2)); }
-
-template <typename L1,
-          typename L2,
-          typename = std::enable_if_t<length<L1>::value == 0>>
-constexpr L2 append_(const L1& l1, const L2& l2) noexcept
-{ return l2; }
-
-template <typename L1,
-          typename L2,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L1>>::value>,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L2>>::value>,
           typename = std::enable_if_t<
                          std::is_same<
-                             typename L1::head_type,
-                             typename L2::head_type
+                             typename std::decay_t<L1>::head_type,
+                             typename std::decay_t<L2>::head_type
                          >::value
                      >>
-constexpr auto append(const L1& l1, const L2& l2) noexcept -> decltype(append_(rev(l1), l2))
-{ return append_(rev(l1), l2); }
+constexpr auto append(L1&& l1, L2&& l2) noexcept
+    -> typename append_type_<std::decay_t<L1>, std::decay_t<L2>>::type
+{
+    IMM_STATS_HOOK(build_(stats::op::append, length<std::decay_t<L1>>::value,
+                          std::is_lvalue_reference<L1>::value ? length<std::decay_t<L1>>::value : 0));
+    IMM_STATS_HOOK(tail_(stats::op::append, length<std::decay_t<L2>>::value,
+                         std::is_lvalue_reference<L2>::value));
+    return typename append_type_<std::decay_t<L1>, std::decay_t<L2>>::type(
+        append_tag_{}, std::forward<L1>(l1), std::forward<L2>(l2));
+}
 
 template <typename L1,
           typename L2,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L1>>::value>,
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L2>>::value>,
           typename = std::enable_if_t<
                          std::is_same<
-                             typename L1::head_type,
-                             typename L2::head_type
+                             typename std::decay_t<L1>::head_type,
+                             typename std::decay_t<L2>::head_type
                          >::value
                      >>
-constexpr auto rev_append(const L1& l1, const L2& l2) noexcept -> decltype(append_(rev(l1), l2))
-{ return append_(l1, l2); }
+constexpr auto rev_append(L1&& l1, L2&& l2) noexcept
+{ return rev_(std::forward<L1>(l1), std::forward<L2>(l2)); }
 
 template <typename L,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>>
-constexpr auto hd(const L& l) noexcept -> typename L::head_type
-{ return l.h; }
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L>>::value>>
+constexpr auto hd(L&& l) noexcept -> typename std::decay_t<L>::head_type
+{ return std::forward<L>(l).h; }
 
 template <typename L,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>>
-constexpr auto tl(const L& l) noexcept -> typename L::tail_type
-{ return l.t; }
+          typename = std::enable_if_t<l::is_imm_list<std::decay_t<L>>::value>>
+constexpr auto tl(L&& l) noexcept -> typename std::decay_t<L>::tail_type
+{ return std::forward<L>(l).t; }
 
 // for_all
+template <typename L,
+          typename Fn,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+bool for_all_(Fn f, const L& l) noexcept {
+    IMM_STATS_HOOK(step_(stats::op::for_all));
+    return f(l.h) && for_all_(f, l.t);
+}
+
+template <typename Fn>
+bool for_all_(Fn f, nil_t) noexcept
+{ return true; }
+
 template <typename L,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>,
@@ -398,8 +725,10 @@ template <typename L,
                              std::function<bool(typename L::head_type)>
                          >::value
                      >>
-bool for_all(Fn f, const L& l) noexcept
-{ return f(l.h) && for_all(f, l.t); }
+bool for_all(Fn f, const L& l) noexcept {
+    IMM_STATS_HOOK(query_(stats::op::for_all));
+    return for_all_(f, l);
+}
 
 // for_all end recursion
 template <typename Fn>
@@ -418,29 +747,19 @@ template <typename A>
 constexpr bool mem(const A&, nil_t) noexcept
 { return false; }
 
-// for_all2
-template <typename L1,
-          typename L2,
+// exists
+template <typename L,
           typename Fn,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
-          typename = std::enable_if_t<l::length<L1>::value == l::length<L2>::value>,
-          typename = std::enable_if_t<
-                         std::is_convertible<
-                             Fn,
-                             std::function<bool(typename L1::head_type,
-                                                typename L2::head_type)>
-                         >::value
-                     >>
-bool for_all2(Fn f, const L1& l1, const L2& l2) noexcept
-{ return f(l1.h, l2.h) && for_all(f, l1.t, l2.t); }
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+bool exists_(Fn f, const L& l) noexcept {
+    IMM_STATS_HOOK(step_(stats::op::exists));
+    return f(l.h) || exists_(f, l.t);
+}
 
-// for_all2 end recursion
 template <typename Fn>
-bool for_all2(Fn f, nil_t, nil_t) noexcept
-{ return true; }
+bool exists_(Fn f, nil_t) noexcept
+{ return false; }
 
-// exists
 template <typename L,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>,
@@ -450,63 +769,52 @@ template <typename L,
                              std::function<bool(typename L::head_type)>
                          >::value
                      >>
-bool exists(Fn f, const L& l) noexcept
-{ return f(l.h) || exists(f, l.t); }
+bool exists(Fn f, const L& l) noexcept {
+    IMM_STATS_HOOK(query_(stats::op::exists));
+    return exists_(f, l);
+}
 
 // exists end recursion
 template <typename Fn>
 bool exists(Fn f, nil_t) noexcept
 { return false; }
 
-// exists
-template <typename L1,
-          typename L2,
+// find
+template <typename L,
           typename Fn,
-          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
-          typename = std::enable_if_t<l::is_imm_list<L2>::value>,
-          typename = std::enable_if_t<l::length<L1>::value == l::length<L2>::value>,
-          typename = std::enable_if_t<
-                         std::is_convertible<
-                             Fn,
-                             std::function<bool(typename L1::head_type,
-                                                typename L2::head_type)>
-                         >::value
-                     >>
-bool exists2(Fn f, const L1& l1, const L2& l2) noexcept {
-    return f(l1.h, l2.h) || exists2(f, l1.t, l2.t);
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<!std::is_same<nil_t, typename L::tail_type>::value>>
+auto find_(Fn f, const L& l) -> typename L::head_type {
+    IMM_STATS_HOOK(step_(stats::op::find));
+    if (f(l.h)) { return l.h; }
+    else { return find_(f, l.t); }
 }
 
-// exists end recursion
-template <typename Fn>
-bool exists2(Fn f, nil_t, nil_t) noexcept
-{ return false; }
 
+// find recursion end
+template <typename L,
+          typename Fn,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<std::is_same<nil_t, typename L::tail_type>::value>,
+          typename = void>
+auto find_(Fn f, const L& l) -> typename L::head_type {
+    IMM_STATS_HOOK(step_(stats::op::find));
+    if (not f(l.h)) { throw not_found{}; }
+    return l.h;
+}
 
-// find
 template <typename L,
           typename Fn,
           typename = std::enable_if_t<l::is_imm_list<L>::value>,
-          typename = std::enable_if_t<!std::is_same<nil_t, typename L::tail_type>::value>,
           typename = std::enable_if_t<
                          std::is_convertible<
                              Fn,
                              std::function<bool(typename L::head_type)>
                          >::value
                      >>
-auto find(Fn f, const L& l) noexcept -> typename L::head_type {
-    if (f(l.h)) { return l.h; }
-    else { return find(f, l.t); }
-}
-
-
-// find recursion end
-template <typename L,
-          typename Fn,
-          typename = std::enable_if_t<l::is_imm_list<L>::value>,
-          typename = std::enable_if_t<std::is_same<nil_t, typename L::tail_type>::value>>
 auto find(Fn f, const L& l) -> typename L::head_type {
-    if (not f(l.h)) { throw not_found{}; }
-    return l.h;
+    IMM_STATS_HOOK(query_(stats::op::find));
+    return find_(f, l);
 }
 
 template <typename A,
@@ -543,6 +851,322 @@ constexpr bool mem_assoc(const A& a, const cons_<std::tuple<A, B>, nil_t>& l) no
     return true;
 }
 
+// lookups without exception, a pointer to the element found or nullptr.
+// the pointer is valid as long as the list is.
+
+// find_opt
+
+template <typename T, typename Fn>
+constexpr const T* find_opt_(Fn&, nil_t) noexcept
+{ return nullptr; }
+
+template <typename T, typename Fn, typename Tail>
+constexpr const T* find_opt_(Fn& f, const cons_<T, Tail>& l) {
+    IMM_STATS_HOOK(step_(stats::op::find));
+    return f(l.h) ? &l.h : find_opt_<T>(f, l.t);
+}
+
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto find_opt(Fn f, const L& l) -> const typename L::head_type* {
+    IMM_STATS_HOOK(query_(stats::op::find));
+    return find_opt_<typename L::head_type>(f, l);
+}
+
+// assoc_opt
+
+template <typename A, typename B>
+constexpr const B* assoc_opt(const A&, nil_t) noexcept
+{ return nullptr; }
+
+template <typename A, typename B, typename Tail>
+constexpr const B* assoc_opt(const A& a, const cons_<std::tuple<A, B>, Tail>& l) noexcept {
+    if (std::get<0>(l.h) == a) { return &std::get<1>(l.h); }
+    return assoc_opt<A, B>(a, l.t);
+}
+
+// at, element i of a homogeneous list in O(1). the nodes are nested so
+// element i + 1 is at the offset of the tail from element i, the same
+// offset for all the nodes: the heads are laid out as an array. lists
+// which are not standard layout and constant evaluation walk the list.
+
+template <typename T>
+constexpr const T& at_walk_(const cons_<T, nil_t>& l, std::size_t) noexcept
+{ return l.h; }
+
+template <typename T, typename Tail>
+constexpr const T& at_walk_(const cons_<T, Tail>& l, std::size_t i) noexcept
+{ return i == 0 ? l.h : at_walk_(l.t, i - 1); }
+
+// true if every node from L to the end of the list has its head first and
+// its tail Stride bytes after it, the heads are then Stride bytes apart.
+template <typename L,
+          std::size_t Stride,
+          bool Last = std::is_same<typename L::tail_type, nil_t>::value>
+struct same_stride_ : std::integral_constant<bool,
+    offsetof(L, h) == 0 && offsetof(L, t) == Stride &&
+    same_stride_<typename L::tail_type, Stride>::value> {};
+template <typename L, std::size_t Stride>
+struct same_stride_<L, Stride, true> : std::integral_constant<bool, offsetof(L, h) == 0> {};
+
+// distance between two heads of a homogeneous list, offsetof is only
+// defined for standard layout types.
+template <typename L>
+struct at_stride_ {
+    static_assert(std::is_standard_layout<L>::value,
+                  "the offsets of the nodes need a list of standard layout elements");
+    static constexpr std::size_t value = offsetof(L, t);
+    static_assert(same_stride_<L, value>::value,
+                  "the nodes of a homogeneous list do not have the same layout");
+};
+
+template <typename L>
+const typename L::head_type& at_offset_(const L& l, std::size_t i) noexcept {
+    return *reinterpret_cast<const typename L::head_type*>(
+        reinterpret_cast<const char*>(&l) + i * at_stride_<L>::value);
+}
+
+template <typename L>
+constexpr auto at_(const L& l, std::size_t i, std::true_type) noexcept -> const typename L::head_type& {
+    if (IMM_IS_CONSTANT_EVALUATED()) { return at_walk_(l, i); }
+    return at_offset_(l, i);
+}
+
+template <typename L>
+constexpr auto at_(const L& l, std::size_t i, std::false_type) noexcept -> const typename L::head_type&
+{ return at_walk_(l, i); }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<
+                         std::is_same<
+                             L,
+                             typename list_type_from_size<
+                                 typename L::head_type,
+                                 length<L>::value
+                             >::type
+                         >::value
+                     >>
+constexpr auto at(const L& l, std::size_t i) -> const typename L::head_type& {
+    if (i >= length<L>::value) { throw not_found{"at"}; }
+    return at_(l, i, std::is_standard_layout<L>{});
+}
+
+// nth_opt, at without exception
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<
+                         std::is_same<
+                             L,
+                             typename list_type_from_size<
+                                 typename L::head_type,
+                                 length<L>::value
+                             >::type
+                         >::value
+                     >>
+constexpr auto nth_opt(const L& l, std::size_t i) noexcept -> const typename L::head_type* {
+    if (i >= length<L>::value) { return nullptr; }
+    return &at_(l, i, std::is_standard_layout<L>{});
+}
+
+// begin / end, the nodes of a homogeneous list have the same layout, each
+// head directly follows the previous one like in an array of T. the
+// iterators are plain pointers so the list is a contiguous random access
+// range for the standard algorithms. the non const overloads allow to
+// sort a list in place. not constexpr.
+
+template <typename L>
+struct is_homogeneous_list : std::integral_constant<bool,
+    std::is_same<L, typename list_type_from_size<typename L::head_type, length<L>::value>::type>::value> {};
+
+// the pointers are valid only if the list has the layout of an array of
+// T: every node is standard layout with its head first and its tail right
+// after the head, so the heads are sizeof(T) bytes apart from the first
+// node to the last. at_stride_ checks the offsets of every node.
+template <typename L>
+struct contiguous_list_ {
+    static_assert(std::is_standard_layout<L>::value,
+                  "iterators need a list of standard layout elements");
+    static_assert(at_stride_<L>::value == sizeof(typename L::head_type),
+                  "the heads of the list are not contiguous");
+    static const typename L::head_type* data(const L& l) noexcept { return &l.h; }
+    static constexpr std::size_t size = length<L>::value;
+};
+
+// taking a cons_ rather than any L makes these overloads more specialized
+// than the deleted ones of std::ranges::begin / end.
+
+template <typename T,
+          typename Tail,
+          typename = std::enable_if_t<l::is_homogeneous_list<cons_<T, Tail>>::value>>
+auto begin(const cons_<T, Tail>& l) noexcept -> const T*
+{ return contiguous_list_<cons_<T, Tail>>::data(l); }
+
+template <typename T,
+          typename Tail,
+          typename = std::enable_if_t<l::is_homogeneous_list<cons_<T, Tail>>::value>>
+auto end(const cons_<T, Tail>& l) noexcept -> const T*
+{ return contiguous_list_<cons_<T, Tail>>::data(l) + contiguous_list_<cons_<T, Tail>>::size; }
+
+template <typename T,
+          typename Tail,
+          typename = std::enable_if_t<l::is_homogeneous_list<cons_<T, Tail>>::value>>
+auto begin(cons_<T, Tail>& l) noexcept -> T*
+{ return const_cast<T*>(begin(static_cast<const cons_<T, Tail>&>(l))); }
+
+template <typename T,
+          typename Tail,
+          typename = std::enable_if_t<l::is_homogeneous_list<cons_<T, Tail>>::value>>
+auto end(cons_<T, Tail>& l) noexcept -> T*
+{ return const_cast<T*>(end(static_cast<const cons_<T, Tail>&>(l))); }
+
+// fold_left, f(... f(f(acc, e0), e1) ..., en). the type of the accumulator
+// may change at each step so heterogeneous lists can be folded.
+template <typename Fn, typename Acc>
+constexpr auto fold_left(Fn, Acc&& acc, nil_t) -> std::decay_t<Acc>
+{ return std::forward<Acc>(acc); }
+
+template <typename Fn,
+          typename Acc,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto fold_left(Fn f, Acc&& acc, const L& l)
+{ return fold_left(f, f(std::forward<Acc>(acc), l.h), l.t); }
+
+// fold_right, f(e0, f(e1, ... f(en, acc)))
+template <typename Fn, typename Acc>
+constexpr auto fold_right(Fn, nil_t, Acc&& acc) -> std::decay_t<Acc>
+{ return std::forward<Acc>(acc); }
+
+template <typename Fn,
+          typename L,
+          typename Acc,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto fold_right(Fn f, const L& l, Acc&& acc)
+{ return f(l.h, fold_right(f, l.t, std::forward<Acc>(acc))); }
+
+// reduce the first N elements of a list as a balanced tree
+
+template <std::size_t N>
+struct reduce_ {
+    template <typename Fn, typename L>
+    static constexpr auto apply(Fn& f, const L& l) {
+        return f(reduce_<N / 2>::apply(f, l),
+                 reduce_<N - N / 2>::apply(f, drop_<N / 2, L>::get(l)));
+    }
+};
+
+template <>
+struct reduce_<1> {
+    template <typename Fn, typename L>
+    static constexpr auto apply(Fn&, const L& l) -> typename L::head_type
+    { return l.h; }
+};
+
+// reduce, f must be associative. elements are combined as a balanced tree:
+// f(f(e0, e1), f(e2, e3)), independent calls can overlap at run time and
+// the compile time recursion depth is log(n) instead of n.
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto reduce(Fn f, const L& l)
+{ return reduce_<length<L>::value>::apply(f, l); }
+
+// construction in one pass, each node is built in place from a source so
+// each element is copied (or moved) exactly once. nested
+// cons(e0, cons(e1, ...)) calls copy the whole tail at each level.
+
+// the elements of a homogeneous make_list, moved only if they are all rvalues
+template <typename T, std::size_t N, bool Move>
+struct args_src_ {
+    template <std::size_t I>
+    constexpr auto get() const -> std::conditional_t<Move, T&&, const T&>
+    { return static_cast<std::conditional_t<Move, T&&, const T&>>(*const_cast<T*>(p[I])); }
+    const T* p[N];
+};
+
+template <typename T, std::size_t N, bool Move>
+struct array_src_ {
+    template <std::size_t I>
+    constexpr auto get() const -> std::conditional_t<Move, T&&, const T&>
+    { return static_cast<std::conditional_t<Move, T&&, const T&>>(const_cast<T&>(a[I])); }
+    const std::array<T, N>& a;
+};
+
+template <typename Fn>
+struct generate_src_ {
+    template <std::size_t I>
+    constexpr auto get() const { return (*f)(I); }
+    Fn* f;
+};
+
+// a const rvalue is copied, moving from it would modify a const object
+template <typename... Ts>
+struct all_rvalues_ : std::true_type {};
+template <typename T, typename... Ts>
+struct all_rvalues_<T, Ts...> : std::integral_constant<bool,
+    !std::is_lvalue_reference<T>::value &&
+    !std::is_const<std::remove_reference_t<T>>::value &&
+    all_rvalues_<Ts...>::value> {};
+
+// the types are all the same if the list of types is equal to its rotation
+template <typename T, typename... Ts>
+struct all_same_ : std::is_same<std::tuple<std::decay_t<T>, std::decay_t<Ts>...>,
+                                std::tuple<std::decay_t<Ts>..., std::decay_t<T>>> {};
+
+// make_list(e0, e1, ..., en)
+
+template <typename T, typename... Ts>
+constexpr auto make_list_(std::true_type, T&& t, Ts&&... ts)
+    -> typename list_type_from_size<std::decay_t<T>, sizeof...(Ts) + 1>::type
+{
+    using src = args_src_<std::decay_t<T>, sizeof...(Ts) + 1, all_rvalues_<T, Ts...>::value>;
+    return typename list_type_from_size<std::decay_t<T>, sizeof...(Ts) + 1>::type(
+        index_<0>{}, src{{&t, &ts...}});
+}
+
+// heterogeneous lists, the elements are forwarded to the piecewise constructor
+template <typename... Ts>
+constexpr auto make_list_(std::false_type, Ts&&... ts)
+    -> typename list_type_from_types<std::decay_t<Ts>...>::type
+{ return typename list_type_from_types<std::decay_t<Ts>...>::type(std::forward<Ts>(ts)...); }
+
+template <typename... Ts,
+          typename = std::enable_if_t<sizeof...(Ts) != 0>>
+constexpr auto make_list(Ts&&... ts)
+    -> typename list_type_from_types<std::decay_t<Ts>...>::type
+{ return make_list_(all_same_<Ts...>{}, std::forward<Ts>(ts)...); }
+
+// from_array, the elements are moved from an rvalue array
+
+template <typename T,
+          std::size_t N,
+          typename = std::enable_if_t<N != 0>>
+constexpr auto from_array(const std::array<T, N>& a)
+    -> typename list_type_from_size<T, N>::type
+{ return typename list_type_from_size<T, N>::type(index_<0>{}, array_src_<T, N, false>{a}); }
+
+template <typename T,
+          std::size_t N,
+          typename = std::enable_if_t<N != 0>>
+constexpr auto from_array(std::array<T, N>&& a)
+    -> typename list_type_from_size<T, N>::type
+{ return typename list_type_from_size<T, N>::type(index_<0>{}, array_src_<T, N, true>{a}); }
+
+// generate<N>(f), [f(0), f(1), ..., f(N - 1)], f is called in order
+
+template <std::size_t N,
+          typename Fn,
+          typename = std::enable_if_t<N != 0>>
+constexpr auto generate(Fn f)
+    -> typename list_type_from_size<std::decay_t<decltype(f(std::size_t{0}))>, N>::type
+{
+    return typename list_type_from_size<std::decay_t<decltype(f(std::size_t{0}))>, N>::type(
+        index_<0>{}, generate_src_<Fn>{&f});
+}
+
 } // f
 
 static constexpr l::nil_t nil{};
@@ -551,33 +1175,43 @@ static constexpr l::empty_t empty{};
 // construct from a element and a list
 template<typename Head,
          typename Tail,
-         typename = std::enable_if_t<l::is_not_nil_t<Head, Tail>::value>,
-         typename = std::enable_if_t<l::is_not_empty_t<Head, Tail>::value>,
-         typename = std::enable_if_t<std::is_same<Head, typename Tail::head_type>::value>>
-constexpr l::cons_<Head, Tail> cons(const Head& h, const Tail& t)
-{ return std::move(l::cons_<Head, Tail>(h, t)); }
+         typename = std::enable_if_t<
+                        l::is_not_nil_t<std::decay_t<Head>, std::decay_t<Tail>>::value>,
+         typename = std::enable_if_t<
+                        l::is_not_empty_t<std::decay_t<Head>, std::decay_t<Tail>>::value>,
+         typename = std::enable_if_t<
+                        std::is_same<
+                            std::decay_t<Head>,
+                            typename std::decay_t<Tail>::head_type
+                        >::value
+                    >>
+constexpr l::cons_<std::decay_t<Head>, std::decay_t<Tail>> cons(Head&& h, Tail&& t)
+{
+    return l::cons_<std::decay_t<Head>, std::decay_t<Tail>>(std::forward<Head>(h),
+                                                            std::forward<Tail>(t));
+}
 
 // contruct from an element + nil
 template<typename Head>
-constexpr l::cons_<Head, l::nil_t> cons(const Head& h, l::nil_t n)
-{ return std::move(l::cons_<Head, l::nil_t>(h, n)); }
+constexpr l::cons_<std::decay_t<Head>, l::nil_t> cons(Head&& h, l::nil_t)
+{ return l::cons_<std::decay_t<Head>, l::nil_t>(std::forward<Head>(h)); }
 
 // constructor from an empty list
 template<typename Head>
-constexpr l::cons_<Head, l::nil_t> cons(const Head& h, l::empty_t e)
-{ return std::move(l::cons_<Head, l::nil_t>(h, nil)); }
+constexpr l::cons_<std::decay_t<Head>, l::nil_t> cons(Head&& h, l::empty_t)
+{ return l::cons_<std::decay_t<Head>, l::nil_t>(std::forward<Head>(h)); }
 
 // constructor from an element
 template <typename Head>
-constexpr l::cons_<Head, l::nil_t> cons(const Head& h)
-{ return std::move(l::cons_<Head, l::nil_t>(h, nil)); }
+constexpr l::cons_<std::decay_t<Head>, l::nil_t> cons(Head&& h)
+{ return l::cons_<std::decay_t<Head>, l::nil_t>(std::forward<Head>(h)); }
 
 template <typename Head,
           typename Tail>
 std::ostream& operator<<(std::ostream& os, const l::cons_<Head, Tail>& l) {
     os << "[";
     std::size_t i = l::length<l::cons_<Head, Tail>>::value;
-    iter([&](Head e) {
+    iter([&](const auto& e) {
         i -= 1;
         os << e;
         if (i != 0) { os << ", "; };
@@ -21,7 +21,62 @@
 // SOFTWARE.
 
 #include <list.h>
+#include <flat_list.h>
+#include <vlist.h>
+#include <assoc_index.h>
+#include <columns.h>
+#include <view.h>
+#include <sort.h>
+#include <binary.h>
+#include <format.h>
+#include <packed.h>
+#include <dyn_list.h>
+#include <atomic_list.h>
+#include <pmap.h>
+#include <algorithm>
+#include <cassert>
 #include <iostream>
+#include <numeric>
+#include <sstream>
+
+struct square {
+    constexpr int operator()(std::size_t i) const { return static_cast<int>(i * i); }
+};
+
+// count copies and moves done by the list operations
+struct counted {
+    static int copies;
+    static int moves;
+    int v;
+    explicit counted(int v) : v(v) {}
+    counted(const counted& o) : v(o.v) { copies += 1; }
+    counted(counted&& o) : v(o.v) { moves += 1; }
+    // print the counts since the last check, they must be the expected ones
+    static void check(const char* op, int expected_copies, int expected_moves) {
+        std::cout << op << " copies: " << copies << ", moves: " << moves << std::endl;
+        assert(copies == expected_copies && moves == expected_moves);
+        copies = 0;
+        moves = 0;
+    }
+};
+
+int counted::copies = 0;
+int counted::moves = 0;
+
+// packed layout size audit on typical heterogeneous lists
+using cdc_list = l::list_type_from_types<char, double, char>::type;
+using record_list = l::list_type_from_types<char, int, char, double, short, char>::type;
+using flags_list = l::list_type_from_types<bool, double, bool, bool>::type;
+static_assert(sizeof(l::packed_of_t<cdc_list>) == 16, "packed char/double/char != 16 bytes");
+static_assert(l::packed_savings<cdc_list>::value >= 8, "packed char/double/char saves < 8 bytes");
+static_assert(l::packed_savings<record_list>::value >= 16, "packed record saves < 16 bytes");
+static_assert(l::packed_savings<flags_list>::value >= 8, "packed flags saves < 8 bytes");
+
+template <typename L>
+void audit_size(const char* name) {
+    std::cout << "packed " << name << ": " << sizeof(L) << " -> " << sizeof(l::packed_of_t<L>)
+              << " bytes, saves " << l::packed_savings<L>::value << std::endl;
+}
 
 template <typename L>
 auto add_element(L l) {
@@ -35,6 +90,13 @@ int main() {
     static_assert(l::hd(a) == 4, "hd a != 4");
     static_assert(l::mem(2, a) == true, "mem a != true");
     static_assert(l::mem(10, a) == false, "mem a != false");
+    constexpr auto ma = l::make_list(4, 3, 2, 1, 0);
+    static_assert(std::is_same<decltype(ma), decltype(a)>::value, "make_list type != cons type");
+    static_assert(l::nth<3>(ma) == l::nth<3>(a), "nth<3> ma != nth<3> a");
+    static_assert(l::at(a, 1) == 3, "at(a, 1) != 3");
+    static_assert(l::nth_opt(a, 5) == nullptr, "nth_opt(a, 5) != nullptr");
+    static_assert(l::nth<2>(l::from_array(std::array<int, 3>{{7, 8, 9}})) == 9, "from_array nth<2> != 9");
+    static_assert(l::nth<4>(l::generate<5>(square{})) == 16, "generate nth<4> != 16");
 
     // print type with an error
     // l::type<decltype(a)> a_type;
@@ -55,6 +117,46 @@ int main() {
     static_assert(i == 84, "assoc('c') != 84");
     static_assert(l::mem_assoc('b', e) == true, "mem_assoc('b', e) != true");
     static_assert(l::mem_assoc('f', e) == false, "mem_assoc('f', e) != false");
+    static_assert(*l::assoc_opt('b', e) == 42, "assoc_opt('b', e) != 42");
+    static_assert(l::assoc_opt('f', e) == nullptr, "assoc_opt('f', e) != nullptr");
+
+    constexpr auto ie = l::make_assoc_index(e);
+    static_assert(l::assoc('c', ie) == 84, "assoc('c', ie) != 84");
+    static_assert(l::mem_assoc('f', ie) == false, "mem_assoc('f', ie) != false");
+    constexpr auto ce = l::to_columns(e);
+    static_assert(l::assoc('b', ce) == 42, "assoc('b', ce) != 42");
+    static_assert(l::assoc_pos('c', ce) == 2, "assoc_pos('c', ce) != 2");
+    constexpr auto se = l::split(e);
+    static_assert(l::nth<1>(l::combine(se.first, se.second)) == l::nth<1>(e), "combine(split(e)) != e");
+
+    constexpr auto fa = l::to_flat(a);
+    static_assert(l::nth<3>(fa) == l::nth<3>(a), "nth<3> fa != nth<3> a");
+    static_assert(l::hd(l::rev(fa)) == 0, "hd rev fa != 0");
+    static_assert(l::mem(2, fa) == true, "mem fa != true");
+    static_assert(l::nth<5>(l::to_cons(l::append(fa, l::to_flat(b)))) == 0, "nth<5> fa @ b != 0");
+
+    constexpr auto va = l::to_vlist(a);
+    static_assert(l::length<decltype(va)>::value == 5, "va length != 5");
+    static_assert(l::nth<0>(l::rev(va)) == 0, "nth<0> rev va != 0");
+    static_assert(l::nth<5>(l::to_cons(l::append(va, l::to_vlist(c)))) == 4, "nth<5> va @ c != 4");
+
+    static_assert(l::fold_left(std::minus<>{}, 10, a) == 0, "fold_left - 10 a != 0");
+    static_assert(l::fold_right(std::minus<>{}, a, 0) == 2, "fold_right - a 0 != 2");
+    static_assert(l::reduce(std::plus<>{}, c) == l::reduce(std::plus<>{}, l::to_flat(c)), "reduce + c != reduce + fc");
+    static_assert(l::nth<3>(l::zip_with(std::plus<>{}, a, ma)) == 2, "nth<3> zip_with + a ma != 2");
+    static_assert(l::zip_all(std::equal_to<>{}, a, ma) && not l::zip_any(std::less<>{}, a, ma), "zip a ma");
+    static_assert(l::nth<1>(l::zip_with(std::multiplies<>{}, fa, fa)) == 9, "nth<1> zip_with * fa fa != 9");
+
+    constexpr auto pa = l::to_packed(cdc_list('a', 2.5, 'b'));
+    static_assert(l::nth<1>(pa) == 2.5 && l::nth<2>(pa) == 'b', "packed index order changed");
+
+    constexpr auto sd = l::sort(d);
+    static_assert(l::nth<0>(sd) == 0 && l::nth<9>(sd) == 14, "sort d is not sorted");
+    constexpr auto ud = l::unique(l::append(a, d));
+    static_assert(ud.size() == 10 && l::mem(13, ud), "unique a @ d size != 10");
+
+    static_assert(l::find(l::lt(3), l::view(c) | l::filter(l::gt(1)) | l::take<4>()) == 2, "find < 3 in view c != 2");
+    static_assert(l::nth<1>(l::to_cons(l::view(fa) | l::take<2>())) == 3, "nth<1> take<2> fa != 3");
 
     std::cout << a << std::endl;
     std::cout << b << std::endl;
@@ -73,6 +175,41 @@ int main() {
     std::cout << "cons(42) len: " << l::length<decltype(cons(42))>::value << std::endl;
     std::cout << "hd a: " << l::hd(a) << std::endl;
     std::cout << "tl a: " << l::tl(a) << std::endl;
+    std::cout << "fa: " << fa << std::endl;
+    std::cout << "exists > 3 in fa: " << l::exists(l::gt(3), fa) << std::endl;
+    std::cout << "view c: ";
+    l::iter([](auto e) { std::cout << e << " "; },
+            l::view(c) | l::map([](auto e) { return e * 2; }) | l::filter(l::gt(10)) | l::take<3>());
+    std::cout << std::endl;
+    std::cout << "sort d: " << sd << std::endl;
+    std::cout << "columns e: " << ce << std::endl;
+    std::cout << "format e: " << l::to_string(e) << std::endl;
+    // the formatter renders lists like operator<<
+    auto mixed = l::make_list(-42, true, 'x', static_cast<signed char>('s'), static_cast<unsigned char>('u'),
+                              2.5, 1e-7, std::string("str"), "cstr", 7ul, false);
+    auto mv = l::make_vlist(true, 'v', 0.25f);
+    std::ostringstream mos;
+    mos << mixed << mv << fa;
+    assert(l::to_string(mixed) + l::to_string(mv) + l::to_string(fa) == mos.str());
+    audit_size<cdc_list>("char, double, char");
+    audit_size<record_list>("char, int, char, double, short, char");
+    audit_size<flags_list>("bool, double, bool, bool");
+    std::ostringstream ba;
+    l::write_binary(ba, a);
+    std::cout << "binary a: " << ba.str().size() << " bytes" << std::endl;
+    l::arena da;
+    auto dl = l::make_dyn_list(da, {5, 4, 3, 2, 1});
+    std::cout << "dyn_list rev tl: " << l::rev(l::tl(dl)) << std::endl;
+    l::arena pma;
+    auto pm = l::add(3, 30, l::add(1, 10, l::pmap<int, int>(pma)));
+    auto pm1 = l::remove(1, pm);
+    std::cout << "pmap: " << pm << ", remove 1: " << pm1
+              << ", mem_assoc 1: " << l::mem_assoc(1, pm1)
+              << ", assoc_opt 2: " << (l::assoc_opt(2, pm) == nullptr ? "none" : "found") << std::endl;
+    l::atomic_list<std::decay_t<decltype(a)>> shared(a);
+    shared.update([](const auto& l) { return l::rev(l); });
+    std::cout << "atomic_list a: " << *shared.load() << std::endl;
+    std::cout << "va: " << l::make_vlist(1, 'a', 2.5) << std::endl;
     std::cout << "nth(0) a: " << l::nth<0>(a) << std::endl;
     std::cout << "nth(3) a: " << l::nth<3>(a) << std::endl;
     std::cout << "nth(4) a: " << l::nth<4>(a) << std::endl;
@@ -81,9 +218,35 @@ int main() {
     add_element(cons(20, cons(10)));
     l::iteri([](std::size_t i, auto e){ std::cout << "i: " << i << " -> " << e << std::endl;}, a);
     l::iter2([](auto e1, auto e2){ std::cout << "e1:" << e1 << ", e2:" << e2 << std::endl;}, a, a);
+    l::zip_iter([](auto e1, auto e2, auto e3){ std::cout << "zip: " << e1 << " " << e2 << " " << e3 << std::endl;},
+                a, l::rev(a), l::map([](auto e){ return e * 0.5; }, a));
+    std::cout << "accumulate a: " << std::accumulate(l::begin(a), l::end(a), 0) << std::endl;
+    auto sa = cons(3, cons(1, cons(4, cons(2))));
+    std::sort(l::begin(sa), l::end(sa));
+    std::cout << "sorted in place:";
+    for (auto e : sa) { std::cout << " " << e; }
+    std::cout << ", lower_bound 3: " << *std::lower_bound(l::begin(sa), l::end(sa), 3) << std::endl;
     auto to_map = cons(1, cons(0, nil));
     l::cons_<float, l::cons_<float, l::nil_t>> m =
         l::map([](auto e){ return static_cast<float>(e * 10); }, to_map);
     l::cons_<float, l::cons_<float, l::nil_t>> mi =
         l::mapi([](std::size_t i, auto e){ return static_cast<float>(e * 10 + i); }, to_map);
+
+    // at most one copy or move per element, except nested cons calls which
+    // move the tail built so far at every level
+    auto cl = cons(counted(1), cons(counted(2), cons(counted(3))));
+    counted::check("build", 0, 6);
+    auto cr = l::rev(cl);
+    counted::check("rev", 3, 0);
+    auto crr = l::rev(std::move(cr));
+    counted::check("rev rvalue", 0, 3);
+    auto ca = l::append(std::move(crr), l::map([](const counted& c) { return counted(c.v); }, cl));
+    counted::check("map + append rvalue", 0, 6);
+    auto cm = l::make_list(counted(1), counted(2), counted(3));
+    counted::check("make_list", 0, 3);
+    auto cn = cons(counted(1), cons(counted(2), cons(counted(3))));
+    counted::check("nested cons", 0, 6);
+    std::cout << "hd cm: " << l::hd(cm).v << ", hd cn: " << l::hd(cn).v << std::endl;
+    std::cout << "hd ca: " << l::hd(ca).v << std::endl;
+    if (l::stats::enabled) { l::stats::report(std::cout); }
 }
@@ -0,0 +1,250 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_PACKED_H
+#define IMM_PACKED_H
+
+#include <list.h>
+#include <tuple>
+#include <utility>
+
+namespace l {
+
+// heterogeneous list with a compact layout. a cons_ pays the alignment
+// padding of every level and one byte for the final nil_t, here the
+// elements are stored by decreasing alignment, empty elements take no
+// space (empty base), and nothing is stored for the end of the list.
+// the storage order is hidden, every operation uses the index order.
+
+// one element, empty classes are a base so they take no room
+template <std::size_t I,
+          typename T,
+          bool = std::is_empty<T>::value && !std::is_final<T>::value>
+struct packed_leaf_ {
+    constexpr explicit packed_leaf_(const T& v)
+    : v(v) {}
+    constexpr const T& get() const noexcept { return v; }
+    T v;
+};
+
+template <std::size_t I, typename T>
+struct packed_leaf_<I, T, true> : T {
+    constexpr explicit packed_leaf_(const T& v)
+    : T(v) {}
+    constexpr const T& get() const noexcept { return *this; }
+};
+
+// storage order: indices sorted by decreasing alignment, stable so equal
+// alignments keep the index order.
+
+template <std::size_t N>
+struct packed_perm_ {
+    std::size_t i[N];
+};
+
+template <std::size_t... A>
+constexpr auto packed_sort_() noexcept -> packed_perm_<sizeof...(A)> {
+    constexpr std::size_t align[] = {A...};
+    packed_perm_<sizeof...(A)> p{};
+    for (std::size_t k = 0; k < sizeof...(A); ++k) { p.i[k] = k; }
+    for (std::size_t k = 1; k < sizeof...(A); ++k) {
+        auto cur = p.i[k];
+        auto j = k;
+        while (j > 0 && align[p.i[j - 1]] < align[cur]) {
+            p.i[j] = p.i[j - 1];
+            j -= 1;
+        }
+        p.i[j] = cur;
+    }
+    return p;
+}
+
+template <typename... Ts>
+struct packed_order_ {
+    static constexpr packed_perm_<sizeof...(Ts)> value = packed_sort_<alignof(Ts)...>();
+};
+
+template <typename... Ts>
+constexpr packed_perm_<sizeof...(Ts)> packed_order_<Ts...>::value;
+
+template <std::size_t I, typename... Ts>
+using packed_type_at_ = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+template <typename Seq, typename... Ts>
+struct packed_impl_;
+
+// the K-th base holds the element of index order[K]
+template <std::size_t... K, typename... Ts>
+struct packed_impl_<std::index_sequence<K...>, Ts...>
+    : packed_leaf_<packed_order_<Ts...>::value.i[K],
+                   packed_type_at_<packed_order_<Ts...>::value.i[K], Ts...>>... {
+    constexpr explicit packed_impl_(const Ts&... vs)
+    : packed_leaf_<packed_order_<Ts...>::value.i[K],
+                   packed_type_at_<packed_order_<Ts...>::value.i[K], Ts...>>(
+          std::get<packed_order_<Ts...>::value.i[K]>(std::tie(vs...)))... {}
+};
+
+template <typename... Ts>
+struct packed_list : packed_impl_<std::index_sequence_for<Ts...>, Ts...> {
+    constexpr explicit packed_list(const Ts&... vs)
+    : packed_impl_<std::index_sequence_for<Ts...>, Ts...>(vs...) {}
+};
+
+template <typename... Ts>
+constexpr packed_list<Ts...> make_packed(const Ts&... vs)
+{ return packed_list<Ts...>{vs...}; }
+
+// is packed list helper
+
+template <typename T>
+struct is_packed_list : std::false_type {};
+template <typename... Ts>
+struct is_packed_list<packed_list<Ts...>> : std::true_type {};
+
+// get the list size
+
+template <std::size_t N, typename... Ts>
+struct length_<N, packed_list<Ts...>> {
+    static constexpr std::size_t value = N + sizeof...(Ts);
+};
+
+// element access by index, the leaf is found by overload resolution
+
+template <std::size_t I, typename T, bool E>
+constexpr const T& packed_get_(const packed_leaf_<I, T, E>& l) noexcept
+{ return l.get(); }
+
+// nth
+
+template <std::size_t N,
+          typename... Ts,
+          typename = std::enable_if_t<(N < sizeof...(Ts))>>
+constexpr auto nth(const packed_list<Ts...>& l) noexcept -> packed_type_at_<N, Ts...>
+{ return packed_get_<N>(l); }
+
+// hd
+
+template <typename... Ts>
+constexpr auto hd(const packed_list<Ts...>& l) noexcept -> packed_type_at_<0, Ts...>
+{ return packed_get_<0>(l); }
+
+// iter, in index order
+
+template <typename Fn, typename... Ts, std::size_t... I>
+void packed_iter_(Fn& f, const packed_list<Ts...>& l, std::index_sequence<I...>) {
+    using expand = int[];
+    (void)expand{0, ((void)f(packed_get_<I>(l)), 0)...};
+}
+
+template <typename Fn, typename... Ts>
+void iter(Fn f, const packed_list<Ts...>& l)
+{ packed_iter_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// iteri
+
+template <typename Fn, typename... Ts, std::size_t... I>
+void packed_iteri_(Fn& f, const packed_list<Ts...>& l, std::index_sequence<I...>) {
+    using expand = int[];
+    (void)expand{0, ((void)f(I, packed_get_<I>(l)), 0)...};
+}
+
+template <typename Fn, typename... Ts>
+void iteri(Fn f, const packed_list<Ts...>& l)
+{ packed_iteri_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// map, the result is packed too
+
+template <typename Fn, typename... Ts, std::size_t... I>
+constexpr auto packed_map_(Fn f, const packed_list<Ts...>& l, std::index_sequence<I...>) noexcept
+    -> packed_list<std::decay_t<decltype(f(std::declval<const Ts&>()))>...>
+{
+    return packed_list<std::decay_t<decltype(f(std::declval<const Ts&>()))>...>{
+        f(packed_get_<I>(l))...
+    };
+}
+
+template <typename Fn, typename... Ts>
+constexpr auto map(Fn f, const packed_list<Ts...>& l) noexcept
+    -> packed_list<std::decay_t<decltype(f(std::declval<const Ts&>()))>...>
+{ return packed_map_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// conversion from a cons_ list, the list is indexed once by elem_refs_
+// then the packed list is built from a single pack of indices.
+
+template <typename R, std::size_t... I>
+constexpr auto to_packed_(const R& r, std::index_sequence<I...>) noexcept
+    -> packed_list<elem_ref_t_<I, R>...>
+{ return packed_list<elem_ref_t_<I, R>...>{elem_ref_get_<I>(r)...}; }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto to_packed(const L& l) noexcept
+{ return to_packed_(elem_refs_<0, L>(l), std::make_index_sequence<length<L>::value>{}); }
+
+// conversion to a cons_ list, each node is built in place by the index_<I>
+// constructor from the element of index I, copied once.
+
+template <typename... Ts>
+struct packed_src_ {
+    template <std::size_t I>
+    constexpr auto get() const noexcept -> const packed_type_at_<I, Ts...>&
+    { return packed_get_<I>(l); }
+    const packed_list<Ts...>& l;
+};
+
+template <typename... Ts>
+constexpr auto to_cons(const packed_list<Ts...>& l) noexcept
+    -> typename list_type_from_types<Ts...>::type
+{ return typename list_type_from_types<Ts...>::type(index_<0>{}, packed_src_<Ts...>{l}); }
+
+// size audit, the packed type of a cons_ list and the bytes it saves
+
+template <typename L>
+struct packed_of_;
+template <typename Head, typename Tail>
+struct packed_of_<cons_<Head, Tail>> {
+    using type = decltype(to_packed(std::declval<const cons_<Head, Tail>&>()));
+};
+
+template <typename L>
+using packed_of_t = typename packed_of_<L>::type;
+
+template <typename L>
+struct packed_savings {
+    static_assert(sizeof(packed_of_t<L>) <= sizeof(L), "the packed list is larger than the list");
+    static constexpr std::size_t value = sizeof(L) - sizeof(packed_of_t<L>);
+};
+
+} // l
+
+template <typename... Ts>
+std::ostream& operator<<(std::ostream& os, const l::packed_list<Ts...>& l) {
+    os << "[";
+    l::iteri([&](std::size_t i, const auto& e) {
+        os << e;
+        if (i + 1 != sizeof...(Ts)) { os << ", "; }
+    }, l);
+    os << "]";
+    return os;
+}
+
+#endif // IMM_PACKED_H
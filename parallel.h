@@ -0,0 +1,391 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_PARALLEL_H
+#define IMM_PARALLEL_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace l {
+
+// work stealing thread pool. a pool of n threads starts n - 1 workers, the
+// thread calling parallel_for is the last one. each worker owns a deque,
+// it pops its own tasks from the back and steals from the front of others.
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency()) {
+        auto n = threads > 1 ? threads - 1 : 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            workers_.emplace_back(new worker_{});
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            threads_.emplace_back([this, i] { loop_(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lk(wait_m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) { t.join(); }
+    }
+
+    std::size_t size() const noexcept { return workers_.size() + 1; }
+
+    // call fn(begin, end) on chunks of grain elements of [0, n) and wait
+    // for all of them, the first exception thrown by fn is rethrown.
+    template <typename Fn>
+    void parallel_for(std::size_t n, std::size_t grain, Fn fn) {
+        if (n == 0) { return; }
+        if (grain == 0) { grain = std::max<std::size_t>(1, n / (4 * size())); }
+        auto chunks = (n + grain - 1) / grain;
+        if (workers_.empty() || chunks == 1) { fn(std::size_t{0}, n); return; }
+
+        std::atomic<std::size_t> left{chunks};
+        std::exception_ptr err;
+        std::mutex err_m;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            auto b = c * grain;
+            auto e = std::min(n, b + grain);
+            push_(c % workers_.size(), [&, b, e] {
+                try { fn(b, e); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lk(err_m);
+                    if (not err) { err = std::current_exception(); }
+                }
+                left.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+        // the calling thread steals until every chunk is done
+        while (left.load(std::memory_order_acquire) != 0) {
+            if (not run_one_(workers_.size())) { std::this_thread::yield(); }
+        }
+        if (err) { std::rethrow_exception(err); }
+    }
+
+private:
+    struct worker_ {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push_(std::size_t w, std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lk(workers_[w]->m);
+            workers_[w]->tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1, std::memory_order_release);
+        { std::lock_guard<std::mutex> lk(wait_m_); }
+        cv_.notify_one();
+    }
+
+    // run a task from our own deque or stolen from another one
+    bool run_one_(std::size_t self) {
+        std::function<void()> task;
+        auto n = workers_.size();
+        for (std::size_t k = 0; k < n && not task; ++k) {
+            auto w = (self + k) % n;
+            std::lock_guard<std::mutex> lk(workers_[w]->m);
+            auto& q = workers_[w]->tasks;
+            if (q.empty()) { continue; }
+            if (w == self) {
+                task = std::move(q.back());
+                q.pop_back();
+            } else {
+                task = std::move(q.front());
+                q.pop_front();
+            }
+        }
+        if (not task) { return false; }
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        return true;
+    }
+
+    void loop_(std::size_t self) {
+        for (;;) {
+            if (run_one_(self)) { continue; }
+            std::unique_lock<std::mutex> lk(wait_m_);
+            cv_.wait(lk, [this] { return stop_ || queued_.load(std::memory_order_acquire) != 0; });
+            if (stop_ && queued_.load(std::memory_order_acquire) == 0) { return; }
+        }
+    }
+
+    std::vector<std::unique_ptr<worker_>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> queued_{0};
+    std::mutex wait_m_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+// execution policies
+
+struct sequential_policy {};
+static constexpr sequential_policy seq{};
+
+struct parallel_policy {
+    thread_pool& pool;
+    std::size_t grain;
+};
+
+inline parallel_policy par(thread_pool& pool, std::size_t grain = 0) noexcept
+{ return parallel_policy{pool, grain}; }
+
+// sequential policy, same as the functions without policy
+
+template <typename Fn, typename L>
+auto map(sequential_policy, Fn f, const L& l) -> decltype(map(f, l))
+{ return map(f, l); }
+
+template <typename Fn, typename L>
+auto mapi(sequential_policy, Fn f, const L& l) -> decltype(mapi(f, l))
+{ return mapi(f, l); }
+
+template <typename Fn, typename L>
+void iter(sequential_policy, Fn f, const L& l)
+{ iter(f, l); }
+
+template <typename Fn, typename L>
+auto reduce(sequential_policy, Fn f, const L& l) -> decltype(reduce(f, l))
+{ return reduce(f, l); }
+
+// random access to the elements of a homogeneous list
+
+template <typename T, std::size_t N>
+struct par_source_ {
+    template <typename L>
+    explicit par_source_(const L& l)
+    : ptrs(new const T*[N]) {
+        std::size_t i = 0;
+        iter([&](const T& e) { ptrs[i++] = &e; }, l);
+    }
+    const T& operator[](std::size_t i) const noexcept { return *ptrs[i]; }
+    std::unique_ptr<const T*[]> ptrs;
+};
+
+template <typename T, std::size_t N>
+struct par_flat_source_ {
+    explicit par_flat_source_(const flat_list<T, N>& l) noexcept
+    : l(l) {}
+    const T& operator[](std::size_t i) const noexcept { return l.data[i]; }
+    const flat_list<T, N>& l;
+};
+
+// uninitialized storage for n results, filled concurrently
+template <typename R>
+struct par_buffer_ {
+    using storage_type = std::aligned_storage_t<sizeof(R), alignof(R)>;
+
+    explicit par_buffer_(std::size_t n)
+    : n(n), storage(new storage_type[n]), built(new bool[n]()) {}
+
+    ~par_buffer_() {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (built[i]) { ptr(i)->~R(); }
+        }
+    }
+
+    R* ptr(std::size_t i) noexcept { return reinterpret_cast<R*>(&storage[i]); }
+
+    template <typename V>
+    void emplace(std::size_t i, V&& v) {
+        new (ptr(i)) R(std::forward<V>(v));
+        built[i] = true;
+    }
+
+    R&& take(std::size_t i) noexcept { return std::move(*ptr(i)); }
+
+    const R& operator[](std::size_t i) const noexcept
+    { return *reinterpret_cast<const R*>(&storage[i]); }
+
+    std::size_t n;
+    std::unique_ptr<storage_type[]> storage;
+    std::unique_ptr<bool[]> built;
+};
+
+// the results are moved out of the buffer by the index_<I> constructor,
+// one node per instantiation instead of a pack of all the results.
+template <typename R>
+struct par_take_src_ {
+    template <std::size_t I>
+    R&& get() const noexcept { return b.take(I); }
+    par_buffer_<R>& b;
+};
+
+template <typename R, std::size_t N>
+auto par_to_cons_(par_buffer_<R>& b) -> typename list_type_from_size<R, N>::type
+{ return typename list_type_from_size<R, N>::type(index_<0>{}, par_take_src_<R>{b}); }
+
+template <typename R, std::size_t... I>
+auto par_to_flat_(par_buffer_<R>& b, std::index_sequence<I...>) -> flat_list<R, sizeof...(I)>
+{ return flat_list<R, sizeof...(I)>{{b.take(I)...}}; }
+
+template <typename R, typename Fn, typename Src>
+void par_fill_(const parallel_policy& p, Fn& f, const Src& src, par_buffer_<R>& b) {
+    p.pool.parallel_for(b.n, p.grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) { b.emplace(i, f(i, src[i])); }
+    });
+}
+
+template <typename Fn, typename Src, std::size_t N>
+void par_iter_(const parallel_policy& p, Fn& f, const Src& src) {
+    p.pool.parallel_for(N, p.grain, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) { f(src[i]); }
+    });
+}
+
+// elements [b, b + n) of a source
+template <typename Src>
+struct par_range_ {
+    const Src& src;
+    std::size_t b;
+    auto operator[](std::size_t i) const noexcept -> decltype(src[0])
+    { return src[b + i]; }
+};
+
+// each chunk is reduced by one task, the partial results are then reduced
+// in order so f only has to be associative.
+template <typename T, typename Fn, typename Src>
+T par_reduce_(const parallel_policy& p, Fn& f, const Src& src, std::size_t n) {
+    auto grain = p.grain != 0 ? p.grain : std::max<std::size_t>(1, n / (4 * p.pool.size()));
+    auto chunks = (n + grain - 1) / grain;
+    par_buffer_<T> b(chunks);
+    p.pool.parallel_for(chunks, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto c = begin; c < end; ++c) {
+            auto lo = c * grain;
+            b.emplace(c, flat_reduce_(f, par_range_<Src>{src, lo}, std::min(n, lo + grain) - lo));
+        }
+    });
+    return flat_reduce_(f, b, chunks);
+}
+
+template <typename L>
+struct is_homogeneous_list_ : std::integral_constant<bool,
+    std::is_same<
+        L,
+        typename list_type_from_size<typename L::head_type, length<L>::value>::type
+    >::value> {};
+
+// parallel map, the results are in the same order and have the same type
+// as the sequential map. f must be safe to call from several threads.
+
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<is_homogeneous_list_<L>::value>>
+auto map(const parallel_policy& p, Fn f, const L& l) {
+    using T = typename L::head_type;
+    using R = std::decay_t<decltype(f(std::declval<const T&>()))>;
+    constexpr auto N = length<L>::value;
+    par_source_<T, N> src(l);
+    par_buffer_<R> b(N);
+    auto g = [&](std::size_t, const T& e) { return f(e); };
+    par_fill_(p, g, src, b);
+    return par_to_cons_<R, N>(b);
+}
+
+template <typename Fn, typename T, std::size_t N>
+auto map(const parallel_policy& p, Fn f, const flat_list<T, N>& l) {
+    using R = std::decay_t<decltype(f(std::declval<const T&>()))>;
+    par_buffer_<R> b(N);
+    auto g = [&](std::size_t, const T& e) { return f(e); };
+    par_fill_(p, g, par_flat_source_<T, N>(l), b);
+    return par_to_flat_(b, std::make_index_sequence<N>{});
+}
+
+// parallel mapi
+
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<is_homogeneous_list_<L>::value>>
+auto mapi(const parallel_policy& p, Fn f, const L& l) {
+    using T = typename L::head_type;
+    using R = std::decay_t<decltype(f(std::size_t{0}, std::declval<const T&>()))>;
+    constexpr auto N = length<L>::value;
+    par_source_<T, N> src(l);
+    par_buffer_<R> b(N);
+    par_fill_(p, f, src, b);
+    return par_to_cons_<R, N>(b);
+}
+
+template <typename Fn, typename T, std::size_t N>
+auto mapi(const parallel_policy& p, Fn f, const flat_list<T, N>& l) {
+    using R = std::decay_t<decltype(f(std::size_t{0}, std::declval<const T&>()))>;
+    par_buffer_<R> b(N);
+    par_fill_(p, f, par_flat_source_<T, N>(l), b);
+    return par_to_flat_(b, std::make_index_sequence<N>{});
+}
+
+// parallel iter, f is called once per element in no particular order
+
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<is_homogeneous_list_<L>::value>>
+void iter(const parallel_policy& p, Fn f, const L& l) {
+    using T = typename L::head_type;
+    constexpr auto N = length<L>::value;
+    par_iter_<Fn, par_source_<T, N>, N>(p, f, par_source_<T, N>(l));
+}
+
+template <typename Fn, typename T, std::size_t N>
+void iter(const parallel_policy& p, Fn f, const flat_list<T, N>& l)
+{ par_iter_<Fn, par_flat_source_<T, N>, N>(p, f, par_flat_source_<T, N>(l)); }
+
+// parallel reduce, f must be associative and safe to call from several
+// threads. the result is the same as the sequential reduce.
+
+template <typename Fn,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>,
+          typename = std::enable_if_t<is_homogeneous_list_<L>::value>>
+auto reduce(const parallel_policy& p, Fn f, const L& l) -> typename L::head_type {
+    using T = typename L::head_type;
+    constexpr auto N = length<L>::value;
+    return par_reduce_<T>(p, f, par_source_<T, N>(l), N);
+}
+
+template <typename Fn, typename T, std::size_t N>
+auto reduce(const parallel_policy& p, Fn f, const flat_list<T, N>& l) -> T
+{ return par_reduce_<T>(p, f, par_flat_source_<T, N>(l), N); }
+
+} // l
+
+#endif // IMM_PARALLEL_H
@@ -0,0 +1,232 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_PLIST_H
+#define IMM_PLIST_H
+
+#include <list.h>
+#include <arena.h>
+#include <cstddef>
+#include <utility>
+
+namespace l {
+
+// persistent list, nodes are immutable and allocated in an arena so a tail
+// is shared by every list built on top of it. prepend and tl are O(1).
+// the lists are valid as long as their arena is alive.
+
+template <typename T>
+struct plist_node_ {
+    T h;
+    const plist_node_* t;
+    std::size_t size;
+};
+
+template <typename T>
+struct plist {
+    using value_type = T;
+    constexpr explicit plist(arena& a) noexcept
+    : n(nullptr), a(&a) {}
+    constexpr plist(const plist_node_<T>* n, arena* a) noexcept
+    : n(n), a(a) {}
+
+    bool empty() const noexcept { return n == nullptr; }
+    std::size_t size() const noexcept { return n == nullptr ? 0 : n->size; }
+
+    const plist_node_<T>* n;
+    arena* a;
+};
+
+// is plist helper
+
+template <typename T>
+struct is_plist : std::false_type {};
+template <typename T>
+struct is_plist<plist<T>> : std::true_type {};
+
+// hd / tl
+
+template <typename T>
+auto hd(const plist<T>& l) -> const T& {
+    if (l.empty()) { throw not_found{"hd"}; }
+    return l.n->h;
+}
+
+template <typename T>
+auto tl(const plist<T>& l) -> plist<T> {
+    if (l.empty()) { throw not_found{"tl"}; }
+    return plist<T>(l.n->t, l.a);
+}
+
+// iter
+
+template <typename T, typename Fn>
+void iter(Fn f, const plist<T>& l) {
+    for (auto n = l.n; n != nullptr; n = n->t) { f(n->h); }
+}
+
+// iteri
+
+template <typename T, typename Fn>
+void iteri(Fn f, const plist<T>& l) {
+    std::size_t i = 0;
+    for (auto n = l.n; n != nullptr; n = n->t) { f(i++, n->h); }
+}
+
+// fresh nodes are linked from front to back while the list is built,
+// they are only published as const once complete.
+template <typename T>
+struct plist_builder_ {
+    explicit plist_builder_(arena& a) noexcept
+    : a(a) {}
+
+    template <typename U>
+    void push(U&& h, std::size_t size) {
+        auto n = a.make<plist_node_<T>>(plist_node_<T>{std::forward<U>(h), nullptr, size});
+        if (last == nullptr) { first = n; } else { last->t = n; }
+        last = n;
+    }
+
+    plist<T> finish(const plist_node_<T>* tail) noexcept {
+        if (last == nullptr) { return plist<T>(tail, &a); }
+        last->t = tail;
+        return plist<T>(first, &a);
+    }
+
+    arena& a;
+    plist_node_<T>* first = nullptr;
+    plist_node_<T>* last = nullptr;
+};
+
+// map
+
+template <typename Fn, typename T>
+auto map(Fn f, const plist<T>& l) -> plist<std::decay_t<decltype(f(l.n->h))>> {
+    plist_builder_<std::decay_t<decltype(f(l.n->h))>> b(*l.a);
+    for (auto n = l.n; n != nullptr; n = n->t) { b.push(f(n->h), n->size); }
+    return b.finish(nullptr);
+}
+
+// mapi
+
+template <typename Fn, typename T>
+auto mapi(Fn f, const plist<T>& l)
+    -> plist<std::decay_t<decltype(f(std::size_t{0}, l.n->h))>> {
+    plist_builder_<std::decay_t<decltype(f(std::size_t{0}, l.n->h))>> b(*l.a);
+    std::size_t i = 0;
+    for (auto n = l.n; n != nullptr; n = n->t) { b.push(f(i++, n->h), n->size); }
+    return b.finish(nullptr);
+}
+
+// rev
+
+template <typename T>
+auto rev_append(const plist<T>& l1, const plist<T>& l2) -> plist<T> {
+    auto r = l2.n;
+    for (auto n = l1.n; n != nullptr; n = n->t) {
+        r = l1.a->template make<plist_node_<T>>(
+            plist_node_<T>{n->h, r, r == nullptr ? 1 : r->size + 1});
+    }
+    return plist<T>(r, l1.a);
+}
+
+template <typename T>
+auto rev(const plist<T>& l) -> plist<T>
+{ return rev_append(l, plist<T>(*l.a)); }
+
+// append, l1 is copied and l2 is shared
+
+template <typename T>
+auto append(const plist<T>& l1, const plist<T>& l2) -> plist<T> {
+    plist_builder_<T> b(*l1.a);
+    for (auto n = l1.n; n != nullptr; n = n->t) { b.push(n->h, n->size + l2.size()); }
+    return b.finish(l2.n);
+}
+
+// mem
+
+template <typename T>
+bool mem(const T& a, const plist<T>& l) noexcept {
+    for (auto n = l.n; n != nullptr; n = n->t) {
+        if (n->h == a) { return true; }
+    }
+    return false;
+}
+
+// exists
+
+template <typename T, typename Fn>
+bool exists(Fn f, const plist<T>& l) noexcept {
+    for (auto n = l.n; n != nullptr; n = n->t) {
+        if (f(n->h)) { return true; }
+    }
+    return false;
+}
+
+// for_all
+
+template <typename T, typename Fn>
+bool for_all(Fn f, const plist<T>& l) noexcept {
+    for (auto n = l.n; n != nullptr; n = n->t) {
+        if (not f(n->h)) { return false; }
+    }
+    return true;
+}
+
+// find
+
+template <typename T, typename Fn>
+auto find(Fn f, const plist<T>& l) -> T {
+    for (auto n = l.n; n != nullptr; n = n->t) {
+        if (f(n->h)) { return n->h; }
+    }
+    throw not_found{};
+}
+
+} // l
+
+// construct from an element and a persistent list, the tail is shared
+template <typename T>
+l::plist<T> cons(const typename l::plist<T>::value_type& h, const l::plist<T>& t) {
+    auto n = t.a->template make<l::plist_node_<T>>(l::plist_node_<T>{h, t.n, t.size() + 1});
+    return l::plist<T>(n, t.a);
+}
+
+template <typename T>
+l::plist<T> cons(typename l::plist<T>::value_type&& h, const l::plist<T>& t) {
+    auto n = t.a->template make<l::plist_node_<T>>(
+        l::plist_node_<T>{std::move(h), t.n, t.size() + 1});
+    return l::plist<T>(n, t.a);
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const l::plist<T>& l) {
+    os << "[";
+    for (auto n = l.n; n != nullptr; n = n->t) {
+        os << n->h;
+        if (n->t != nullptr) { os << ", "; }
+    }
+    os << "]";
+    return os;
+}
+
+#endif // IMM_PLIST_H
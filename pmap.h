@@ -0,0 +1,457 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_PMAP_H
+#define IMM_PMAP_H
+
+#include <list.h>
+#include <arena.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+namespace l {
+
+// persistent hash map, a hash array mapped trie: every node consumes 5
+// bits of the hash and holds up to 32 slots, so a lookup visits at most
+// log32(n) nodes. add and remove copy the path to the key and share the
+// rest, the maps are valid as long as their arena is alive.
+//
+// a node only stores its occupied slots: datamap has a bit per slot
+// holding an entry, nodemap a bit per slot holding a child, and the index
+// of a slot in its array is the popcount of the bits below it. once the
+// hash is consumed the keys which collide are kept in a flat node.
+// the maps are canonical: a child always holds more than one entry.
+
+template <typename K, typename V>
+struct pmap_entry_ {
+    K k;
+    V v;
+};
+
+template <typename K, typename V>
+struct pmap_node_ {
+    std::uint32_t datamap;
+    std::uint32_t nodemap;
+    std::uint32_t nentries;
+    const pmap_entry_<K, V>* entries;
+    const pmap_node_* const* children;
+};
+
+template <typename K,
+          typename V,
+          typename Hash = std::hash<K>,
+          typename Eq = std::equal_to<K>>
+struct pmap {
+    using key_type = K;
+    using mapped_type = V;
+    using node_type = pmap_node_<K, V>;
+    explicit pmap(arena& a) noexcept
+    : n(nullptr), count(0), a(&a) {}
+    pmap(const node_type* n, std::size_t count, arena* a) noexcept
+    : n(n), count(count), a(a) {}
+
+    bool empty() const noexcept { return count == 0; }
+    std::size_t size() const noexcept { return count; }
+
+    const node_type* n;
+    std::size_t count;
+    arena* a;
+};
+
+// is pmap helper
+
+template <typename T>
+struct is_pmap : std::false_type {};
+template <typename K, typename V, typename Hash, typename Eq>
+struct is_pmap<pmap<K, V, Hash, Eq>> : std::true_type {};
+
+// implementation of the trie
+
+template <typename K, typename V, typename Hash, typename Eq>
+struct pmap_trie_ {
+    using entry = pmap_entry_<K, V>;
+    using node = pmap_node_<K, V>;
+
+    static constexpr unsigned bits = 5;
+    static constexpr unsigned hash_bits = sizeof(std::size_t) * 8;
+
+    static std::uint32_t bit(std::size_t h, unsigned shift) noexcept
+    { return std::uint32_t{1} << ((h >> shift) & 31); }
+
+    static std::uint32_t index(std::uint32_t map, std::uint32_t bit) noexcept
+    { return static_cast<std::uint32_t>(__builtin_popcount(map & (bit - 1))); }
+
+    static std::uint32_t nchildren(const node* n) noexcept
+    { return static_cast<std::uint32_t>(__builtin_popcount(n->nodemap)); }
+
+    static constexpr std::size_t align_up(std::size_t n, std::size_t a) noexcept
+    { return (n + a - 1) & ~(a - 1); }
+
+    // a node and its two arrays in one allocation, entry_at(i) and
+    // child_at(i) give the slots of the new node.
+    template <typename EntryAt, typename ChildAt>
+    static const node* make(arena& a, std::uint32_t datamap, std::uint32_t nodemap,
+                            std::uint32_t ne, std::uint32_t nc,
+                            EntryAt entry_at, ChildAt child_at) {
+        constexpr std::size_t eoff = align_up(sizeof(node), alignof(entry));
+        const std::size_t coff = align_up(eoff + ne * sizeof(entry), alignof(const node*));
+        constexpr std::size_t al = alignof(node) > alignof(entry) ? alignof(node) : alignof(entry);
+        auto p = static_cast<char*>(a.allocate(coff + nc * sizeof(const node*), al));
+        auto es = reinterpret_cast<entry*>(p + eoff);
+        std::uint32_t i = 0;
+        try {
+            for (; i < ne; ++i) { new (es + i) entry(entry_at(i)); }
+        } catch (...) {
+            while (i > 0) { es[--i].~entry(); }
+            throw;
+        }
+        a.destroy_later(es, ne);
+        auto cs = reinterpret_cast<const node**>(p + coff);
+        for (i = 0; i < nc; ++i) { cs[i] = child_at(i); }
+        return new (p) node{datamap, nodemap, ne, es, cs};
+    }
+
+    static const node* no_child(std::uint32_t) noexcept { return nullptr; }
+
+    // lookup
+
+    static const entry* find(const node* n, const K& k) noexcept {
+        auto h = Hash{}(k);
+        for (unsigned shift = 0; n != nullptr; shift += bits) {
+            if (shift >= hash_bits) {
+                for (std::uint32_t i = 0; i < n->nentries; ++i) {
+                    if (Eq{}(n->entries[i].k, k)) { return &n->entries[i]; }
+                }
+                return nullptr;
+            }
+            auto b = bit(h, shift);
+            if ((n->datamap & b) != 0) {
+                auto& e = n->entries[index(n->datamap, b)];
+                return Eq{}(e.k, k) ? &e : nullptr;
+            }
+            if ((n->nodemap & b) == 0) { return nullptr; }
+            n = n->children[index(n->nodemap, b)];
+        }
+        return nullptr;
+    }
+
+    // subtree holding the two entries, which hashes differ from shift on
+    static const node* pair(arena& a, const entry& e1, std::size_t h1,
+                            const entry& e2, std::size_t h2, unsigned shift) {
+        if (shift >= hash_bits) {
+            return make(a, 0, 0, 2, 0,
+                        [&](std::uint32_t i) -> const entry& { return i == 0 ? e1 : e2; },
+                        no_child);
+        }
+        auto b1 = bit(h1, shift);
+        auto b2 = bit(h2, shift);
+        if (b1 == b2) {
+            auto c = pair(a, e1, h1, e2, h2, shift + bits);
+            return make(a, 0, b1, 0, 1,
+                        [&](std::uint32_t) -> const entry& { return e1; },
+                        [&](std::uint32_t) { return c; });
+        }
+        return make(a, b1 | b2, 0, 2, 0,
+                    [&](std::uint32_t i) -> const entry& { return (i == 0) == (b1 < b2) ? e1 : e2; },
+                    no_child);
+    }
+
+    // copy of n with its entry i replaced
+    static const node* set_entry(arena& a, const node* n, std::uint32_t i, const entry& e) {
+        return make(a, n->datamap, n->nodemap, n->nentries, nchildren(n),
+                    [&](std::uint32_t k) -> const entry& { return k == i ? e : n->entries[k]; },
+                    [&](std::uint32_t k) { return n->children[k]; });
+    }
+
+    // copy of n with e inserted as its entry i, and its child j removed
+    // when the slot of e held a child
+    static const node* insert_entry(arena& a, const node* n, std::uint32_t datamap,
+                                    std::uint32_t nodemap, std::uint32_t i, const entry& e,
+                                    std::uint32_t j, bool drop_child) {
+        return make(a, datamap, nodemap, n->nentries + 1, nchildren(n) - drop_child,
+                    [&](std::uint32_t k) -> const entry& {
+                        return k < i ? n->entries[k] : k == i ? e : n->entries[k - 1];
+                    },
+                    [&](std::uint32_t k) { return n->children[drop_child && k >= j ? k + 1 : k]; });
+    }
+
+    // copy of n with its entry i removed, and c inserted as its child j
+    // when the slot of the entry now holds a child
+    static const node* remove_entry(arena& a, const node* n, std::uint32_t datamap,
+                                    std::uint32_t nodemap, std::uint32_t i,
+                                    const node* c, std::uint32_t j) {
+        bool add_child = c != nullptr;
+        return make(a, datamap, nodemap, n->nentries - 1, nchildren(n) + add_child,
+                    [&](std::uint32_t k) -> const entry& { return n->entries[k < i ? k : k + 1]; },
+                    [&](std::uint32_t k) {
+                        if (not add_child || k < j) { return n->children[k]; }
+                        return k == j ? c : n->children[k - 1];
+                    });
+    }
+
+    // copy of n with its child j replaced
+    static const node* set_child(arena& a, const node* n, std::uint32_t j, const node* c) {
+        return make(a, n->datamap, n->nodemap, n->nentries, nchildren(n),
+                    [&](std::uint32_t k) -> const entry& { return n->entries[k]; },
+                    [&](std::uint32_t k) { return k == j ? c : n->children[k]; });
+    }
+
+    // add, added is set when the key was not in the map
+
+    static const node* add(arena& a, const node* n, const entry& e, std::size_t h,
+                           unsigned shift, bool& added) {
+        if (shift >= hash_bits) {
+            for (std::uint32_t i = 0; i < n->nentries; ++i) {
+                if (Eq{}(n->entries[i].k, e.k)) { return set_entry(a, n, i, e); }
+            }
+            added = true;
+            return insert_entry(a, n, 0, 0, n->nentries, e, 0, false);
+        }
+        auto b = bit(h, shift);
+        if ((n->datamap & b) != 0) {
+            auto i = index(n->datamap, b);
+            auto& cur = n->entries[i];
+            if (Eq{}(cur.k, e.k)) { return set_entry(a, n, i, e); }
+            added = true;
+            auto c = pair(a, cur, Hash{}(cur.k), e, h, shift + bits);
+            return remove_entry(a, n, n->datamap & ~b, n->nodemap | b, i, c, index(n->nodemap, b));
+        }
+        if ((n->nodemap & b) != 0) {
+            auto j = index(n->nodemap, b);
+            return set_child(a, n, j, add(a, n->children[j], e, h, shift + bits, added));
+        }
+        added = true;
+        return insert_entry(a, n, n->datamap | b, n->nodemap, index(n->datamap, b), e, 0, false);
+    }
+
+    // remove, returns n itself when the key is not in the map and nullptr
+    // when the node is left empty
+
+    static const node* remove(arena& a, const node* n, const K& k, std::size_t h, unsigned shift) {
+        if (shift >= hash_bits) {
+            for (std::uint32_t i = 0; i < n->nentries; ++i) {
+                if (not Eq{}(n->entries[i].k, k)) { continue; }
+                if (n->nentries == 1) { return nullptr; }
+                return remove_entry(a, n, 0, 0, i, nullptr, 0);
+            }
+            return n;
+        }
+        auto b = bit(h, shift);
+        if ((n->datamap & b) != 0) {
+            auto i = index(n->datamap, b);
+            if (not Eq{}(n->entries[i].k, k)) { return n; }
+            if (n->nentries == 1 && n->nodemap == 0) { return nullptr; }
+            return remove_entry(a, n, n->datamap & ~b, n->nodemap, i, nullptr, 0);
+        }
+        if ((n->nodemap & b) == 0) { return n; }
+        auto j = index(n->nodemap, b);
+        auto old = n->children[j];
+        auto c = remove(a, old, k, h, shift + bits);
+        if (c == old) { return n; }
+        // a child left with a single entry is moved up in its slot
+        if (c != nullptr && (c->nodemap != 0 || c->nentries != 1)) { return set_child(a, n, j, c); }
+        if (c == nullptr) {
+            if (n->nentries == 0 && n->nodemap == b) { return nullptr; }
+            return make(a, n->datamap, n->nodemap & ~b, n->nentries, nchildren(n) - 1,
+                        [&](std::uint32_t i) -> const entry& { return n->entries[i]; },
+                        [&](std::uint32_t i) { return n->children[i < j ? i : i + 1]; });
+        }
+        return insert_entry(a, n, n->datamap | b, n->nodemap & ~b, index(n->datamap, b),
+                            c->entries[0], j, true);
+    }
+
+    // bulk build from the entries es, of hashes hs. [first, last) are the
+    // indices of the entries in the subtree, tmp a buffer of the same size.
+    // the last entry of a key wins.
+
+    static const node* build(arena& a, const entry* es, const std::size_t* hs,
+                             std::size_t* first, std::size_t* last, std::size_t* tmp,
+                             unsigned shift, std::size_t& count) {
+        if (shift >= hash_bits) {
+            std::uint32_t ne = 0;
+            for (auto i = first; i != last; ++i) {
+                bool replaced = false;
+                for (auto j = i + 1; j != last && not replaced; ++j) { replaced = Eq{}(es[*i].k, es[*j].k); }
+                if (not replaced) { tmp[ne++] = *i; }
+            }
+            count += ne;
+            return make(a, 0, 0, ne, 0,
+                        [&](std::uint32_t k) -> const entry& { return es[tmp[k]]; },
+                        no_child);
+        }
+        // stable counting sort of the indices on the 5 bits of this level
+        std::size_t start[33] = {};
+        for (auto i = first; i != last; ++i) { start[((hs[*i] >> shift) & 31) + 1] += 1; }
+        for (unsigned d = 0; d < 32; ++d) { start[d + 1] += start[d]; }
+        std::size_t pos[32];
+        for (unsigned d = 0; d < 32; ++d) { pos[d] = start[d]; }
+        for (auto i = first; i != last; ++i) { tmp[pos[(hs[*i] >> shift) & 31]++] = *i; }
+        for (std::size_t i = 0, n = last - first; i < n; ++i) { first[i] = tmp[i]; }
+
+        std::uint32_t datamap = 0, nodemap = 0, ne = 0, nc = 0;
+        const entry* ents[32];
+        const node* kids[32];
+        for (unsigned d = 0; d < 32; ++d) {
+            auto size = start[d + 1] - start[d];
+            if (size == 0) { continue; }
+            auto b = std::uint32_t{1} << d;
+            if (size == 1) {
+                datamap |= b;
+                ents[ne++] = &es[first[start[d]]];
+                count += 1;
+                continue;
+            }
+            auto c = build(a, es, hs, first + start[d], first + start[d + 1], tmp + start[d],
+                           shift + bits, count);
+            // all the entries of the slot had the same key
+            if (c->nodemap == 0 && c->nentries == 1) {
+                datamap |= b;
+                ents[ne++] = &c->entries[0];
+                continue;
+            }
+            nodemap |= b;
+            kids[nc++] = c;
+        }
+        return make(a, datamap, nodemap, ne, nc,
+                    [&](std::uint32_t k) -> const entry& { return *ents[k]; },
+                    [&](std::uint32_t k) { return kids[k]; });
+    }
+
+    // iter
+
+    template <typename Fn>
+    static void iter(Fn& f, const node* n) {
+        if (n == nullptr) { return; }
+        for (std::uint32_t i = 0; i < n->nentries; ++i) { f(n->entries[i].k, n->entries[i].v); }
+        for (std::uint32_t j = 0, c = nchildren(n); j < c; ++j) { iter(f, n->children[j]); }
+    }
+};
+
+// make_pmap, from a range of (key, value) pairs or tuples. every node is
+// allocated once, where successive adds copy the path of every key. the
+// last value of a key is kept.
+
+template <typename K,
+          typename V,
+          typename Hash = std::hash<K>,
+          typename Eq = std::equal_to<K>,
+          typename It>
+auto make_pmap(arena& a, It first, It last) -> pmap<K, V, Hash, Eq> {
+    using trie = pmap_trie_<K, V, Hash, Eq>;
+    std::vector<pmap_entry_<K, V>> es;
+    for (; first != last; ++first) { es.push_back(pmap_entry_<K, V>{std::get<0>(*first), std::get<1>(*first)}); }
+    if (es.empty()) { return pmap<K, V, Hash, Eq>(a); }
+    std::vector<std::size_t> hs(es.size());
+    std::vector<std::size_t> idx(es.size());
+    std::vector<std::size_t> tmp(es.size());
+    for (std::size_t i = 0; i < es.size(); ++i) {
+        hs[i] = Hash{}(es[i].k);
+        idx[i] = i;
+    }
+    std::size_t count = 0;
+    auto n = trie::build(a, es.data(), hs.data(), idx.data(), idx.data() + idx.size(), tmp.data(),
+                         0, count);
+    return pmap<K, V, Hash, Eq>(n, count, &a);
+}
+
+// add, the value of a key already in the map is replaced
+
+template <typename K, typename V, typename Hash, typename Eq>
+auto add(const typename pmap<K, V, Hash, Eq>::key_type& k,
+         const typename pmap<K, V, Hash, Eq>::mapped_type& v,
+         const pmap<K, V, Hash, Eq>& m) -> pmap<K, V, Hash, Eq> {
+    using trie = pmap_trie_<K, V, Hash, Eq>;
+    pmap_entry_<K, V> e{k, v};
+    if (m.n == nullptr) {
+        auto n = trie::make(*m.a, trie::bit(Hash{}(k), 0), 0, 1, 0,
+                            [&](std::uint32_t) -> const pmap_entry_<K, V>& { return e; },
+                            trie::no_child);
+        return pmap<K, V, Hash, Eq>(n, 1, m.a);
+    }
+    bool added = false;
+    auto n = trie::add(*m.a, m.n, e, Hash{}(k), 0, added);
+    return pmap<K, V, Hash, Eq>(n, m.count + added, m.a);
+}
+
+// remove, the map itself when the key is not in it
+
+template <typename K, typename V, typename Hash, typename Eq>
+auto remove(const typename pmap<K, V, Hash, Eq>::key_type& k,
+            const pmap<K, V, Hash, Eq>& m) -> pmap<K, V, Hash, Eq> {
+    if (m.n == nullptr) { return m; }
+    auto n = pmap_trie_<K, V, Hash, Eq>::remove(*m.a, m.n, k, Hash{}(k), 0);
+    if (n == m.n) { return m; }
+    return pmap<K, V, Hash, Eq>(n, m.count - 1, m.a);
+}
+
+// assoc
+
+template <typename K, typename V, typename Hash, typename Eq>
+auto assoc(const typename pmap<K, V, Hash, Eq>::key_type& k,
+           const pmap<K, V, Hash, Eq>& m) -> const V& {
+    auto e = pmap_trie_<K, V, Hash, Eq>::find(m.n, k);
+    if (e == nullptr) { throw not_found{"assoc"}; }
+    return e->v;
+}
+
+// assoc_opt, nullptr when the key is not in the map
+
+template <typename K, typename V, typename Hash, typename Eq>
+auto assoc_opt(const typename pmap<K, V, Hash, Eq>::key_type& k,
+               const pmap<K, V, Hash, Eq>& m) noexcept -> const V* {
+    auto e = pmap_trie_<K, V, Hash, Eq>::find(m.n, k);
+    return e == nullptr ? nullptr : &e->v;
+}
+
+// mem_assoc
+
+template <typename K, typename V, typename Hash, typename Eq>
+bool mem_assoc(const typename pmap<K, V, Hash, Eq>::key_type& k,
+               const pmap<K, V, Hash, Eq>& m) noexcept
+{ return pmap_trie_<K, V, Hash, Eq>::find(m.n, k) != nullptr; }
+
+// iter, f(key, value) in no particular order
+
+template <typename K, typename V, typename Hash, typename Eq, typename Fn>
+void iter(Fn f, const pmap<K, V, Hash, Eq>& m)
+{ pmap_trie_<K, V, Hash, Eq>::iter(f, m.n); }
+
+} // l
+
+template <typename K, typename V, typename Hash, typename Eq>
+std::ostream& operator<<(std::ostream& os, const l::pmap<K, V, Hash, Eq>& m) {
+    os << "{";
+    bool first = true;
+    l::iter([&](const K& k, const V& v) {
+        os << (first ? "" : ", ") << k << ": " << v;
+        first = false;
+    }, m);
+    os << "}";
+    return os;
+}
+
+#endif // IMM_PMAP_H
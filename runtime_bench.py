@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Jeremy Letang
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# runtime benchmarks of bench/*.cpp.
+#
+# every selected benchmark is compiled, run, and its json lines are
+# collected in one report holding the commit, the compiler and the flags.
+# a previous report given with --baseline is compared measure by measure,
+# the ratios above the threshold are printed and make the exit status 1.
+#
+#   ./runtime_bench.py -o new.json                       # bench/ops.cpp
+#   ./runtime_bench.py --benches ops,zip,lookup -o new.json
+#   ./runtime_bench.py --baseline old.json --threshold 1.10
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+
+# flags some benchmarks need on top of the common ones
+EXTRA_FLAGS = {
+    "atomic_list": ["-pthread"],
+    "parallel": ["-pthread"],
+    "construct": ["-ftemplate-depth=4096"],
+}
+
+
+def git_commit():
+    try:
+        out = subprocess.check_output(["git", "-C", ROOT, "rev-parse", "--short", "HEAD"],
+                                      stderr=subprocess.DEVNULL)
+        return out.decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def run_one(args, name, workdir):
+    src = os.path.join(ROOT, "bench", name + ".cpp")
+    exe = os.path.join(workdir, name)
+    cmd = [args.cxx, "-std=" + args.std, args.opt, "-I", ROOT, src, "-o", exe]
+    cmd += EXTRA_FLAGS.get(name, []) + args.cxxflags
+    build = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    if build.returncode != 0:
+        err = build.stderr.decode(errors="replace").strip().splitlines()
+        print("{}: compilation failed: {}".format(name, err[-1] if err else "?"), file=sys.stderr)
+        return None
+    run = subprocess.run([exe], stdout=subprocess.PIPE)
+    if run.returncode != 0:
+        print("{}: exited with {}".format(name, run.returncode), file=sys.stderr)
+        return None
+    results = []
+    for line in run.stdout.decode(errors="replace").splitlines():
+        line = line.strip()
+        if line.startswith("{"):
+            results.append(json.loads(line))
+    return results
+
+
+def key(r):
+    return (r["suite"], r["impl"], r["op"], r["size"])
+
+
+# ratios new / old of ns_per_op, the measures above threshold are regressions
+def compare(old, new, threshold):
+    before = {key(r): r for r in old["results"]}
+    regressions = []
+    for r in new["results"]:
+        o = before.get(key(r))
+        if o is None or o["ns_per_op"] <= 0:
+            continue
+        ratio = r["ns_per_op"] / o["ns_per_op"]
+        if ratio > threshold:
+            regressions.append((ratio, r, o))
+    regressions.sort(key=lambda e: -e[0])
+    for ratio, r, o in regressions:
+        print("{:>6.2f}x  {} {} {} {}: {:.2f} -> {:.2f} ns".format(
+            ratio, r["suite"], r["impl"], r["op"], r["size"], o["ns_per_op"], r["ns_per_op"]))
+    print("{} regressions above {:.2f}x against {}".format(
+        len(regressions), threshold, old.get("commit") or "baseline"), file=sys.stderr)
+    return regressions
+
+
+def main():
+    p = argparse.ArgumentParser(description="runtime benchmarks of bench/*.cpp")
+    p.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    p.add_argument("--std", default="c++14")
+    p.add_argument("--opt", default="-O2")
+    p.add_argument("--benches", default="ops",
+                   help="comma separated names of bench/*.cpp files, or 'all'")
+    p.add_argument("--cxxflags", default="", help="extra compiler flags")
+    p.add_argument("--baseline", help="previous json report to compare with")
+    p.add_argument("--threshold", type=float, default=1.10,
+                   help="ratio of ns_per_op reported as a regression")
+    p.add_argument("-o", "--output", help="json output file (default: stdout)")
+    args = p.parse_args()
+    args.cxxflags = args.cxxflags.split()
+
+    available = sorted(f[:-4] for f in os.listdir(os.path.join(ROOT, "bench")) if f.endswith(".cpp"))
+    names = available if args.benches == "all" else [b for b in args.benches.split(",") if b]
+    for n in names:
+        if n not in available:
+            p.error("unknown benchmark '{}', expected one of {}".format(n, ", ".join(available)))
+
+    workdir = tempfile.mkdtemp(prefix="tmule_runtime_")
+    results = []
+    failed = False
+    for n in names:
+        print("running " + n, file=sys.stderr)
+        r = run_one(args, n, workdir)
+        if r is None:
+            failed = True
+            continue
+        results += r
+    for f in os.listdir(workdir):
+        os.remove(os.path.join(workdir, f))
+    os.rmdir(workdir)
+
+    report = {
+        "commit": git_commit(),
+        "compiler": args.cxx,
+        "std": args.std,
+        "flags": [args.opt] + args.cxxflags,
+        "results": results,
+    }
+    out = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(out + "\n")
+    else:
+        print(out)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            if compare(json.load(f), report, args.threshold):
+                failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
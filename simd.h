@@ -0,0 +1,272 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_SIMD_H
+#define IMM_SIMD_H
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// IMM_IS_CONSTANT_EVALUATED, kernels below are not constexpr so they are
+// only used when it is false.
+#include <stats.h>
+
+namespace l {
+
+// comparison predicates, still usable as plain functions but recognized by
+// the flat_list algorithms which then compare many elements at once.
+
+enum class cmp_op { eq, ne, lt, le, gt, ge };
+
+template <cmp_op Op, typename T>
+struct cmp_ {
+    using value_type = T;
+    static constexpr bool apply(const T& e, const T& v) noexcept {
+        switch (Op) {
+        case cmp_op::eq: return e == v;
+        case cmp_op::ne: return e != v;
+        case cmp_op::lt: return e < v;
+        case cmp_op::le: return e <= v;
+        case cmp_op::gt: return e > v;
+        case cmp_op::ge: return e >= v;
+        }
+        return false;
+    }
+    constexpr bool operator()(const T& e) const noexcept
+    { return apply(e, v); }
+    T v;
+};
+
+template <typename T>
+constexpr cmp_<cmp_op::eq, T> eq(const T& v) noexcept { return cmp_<cmp_op::eq, T>{v}; }
+template <typename T>
+constexpr cmp_<cmp_op::ne, T> ne(const T& v) noexcept { return cmp_<cmp_op::ne, T>{v}; }
+template <typename T>
+constexpr cmp_<cmp_op::lt, T> lt(const T& v) noexcept { return cmp_<cmp_op::lt, T>{v}; }
+template <typename T>
+constexpr cmp_<cmp_op::le, T> le(const T& v) noexcept { return cmp_<cmp_op::le, T>{v}; }
+template <typename T>
+constexpr cmp_<cmp_op::gt, T> gt(const T& v) noexcept { return cmp_<cmp_op::gt, T>{v}; }
+template <typename T>
+constexpr cmp_<cmp_op::ge, T> ge(const T& v) noexcept { return cmp_<cmp_op::ge, T>{v}; }
+
+namespace simd {
+
+// element types with a vectorized kernel
+template <typename T>
+struct is_simd_type : std::integral_constant<bool,
+    std::is_same<T, int>::value ||
+    std::is_same<T, float>::value ||
+    std::is_same<T, double>::value> {};
+
+// lanes_<T> describes one vector register of T for the selected
+// instruction set: width, load, broadcast and the bit mask of a comparison.
+template <typename T>
+struct lanes_;
+
+#if defined(__AVX2__)
+
+template <>
+struct lanes_<int> {
+    using reg = __m256i;
+    static constexpr std::size_t width = 8;
+    static constexpr unsigned all = 0xff;
+    static reg load(const int* p) noexcept
+    { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static reg set1(int v) noexcept { return _mm256_set1_epi32(v); }
+    static unsigned bits(reg r) noexcept
+    { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(r))); }
+    static unsigned eq(reg a, reg b) noexcept { return bits(_mm256_cmpeq_epi32(a, b)); }
+    static unsigned gt(reg a, reg b) noexcept { return bits(_mm256_cmpgt_epi32(a, b)); }
+};
+
+template <>
+struct lanes_<float> {
+    using reg = __m256;
+    static constexpr std::size_t width = 8;
+    template <int P>
+    static unsigned cmp(reg a, reg b) noexcept
+    { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, P))); }
+    static reg load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    static reg set1(float v) noexcept { return _mm256_set1_ps(v); }
+};
+
+template <>
+struct lanes_<double> {
+    using reg = __m256d;
+    static constexpr std::size_t width = 4;
+    template <int P>
+    static unsigned cmp(reg a, reg b) noexcept
+    { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, P))); }
+    static reg load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+    static reg set1(double v) noexcept { return _mm256_set1_pd(v); }
+};
+
+// floating point comparisons map to the ordered/unordered predicates
+// matching the c++ operators when a NaN is involved.
+template <cmp_op Op>
+struct fp_pred_;
+template <> struct fp_pred_<cmp_op::eq> { static constexpr int value = _CMP_EQ_OQ; };
+template <> struct fp_pred_<cmp_op::ne> { static constexpr int value = _CMP_NEQ_UQ; };
+template <> struct fp_pred_<cmp_op::lt> { static constexpr int value = _CMP_LT_OQ; };
+template <> struct fp_pred_<cmp_op::le> { static constexpr int value = _CMP_LE_OQ; };
+template <> struct fp_pred_<cmp_op::gt> { static constexpr int value = _CMP_GT_OQ; };
+template <> struct fp_pred_<cmp_op::ge> { static constexpr int value = _CMP_GE_OQ; };
+
+template <cmp_op Op, typename T>
+unsigned fp_mask_(typename lanes_<T>::reg a, typename lanes_<T>::reg b) noexcept
+{ return lanes_<T>::template cmp<fp_pred_<Op>::value>(a, b); }
+
+#define IMM_SIMD_ENABLED 1
+
+#elif defined(__SSE2__)
+
+template <>
+struct lanes_<int> {
+    using reg = __m128i;
+    static constexpr std::size_t width = 4;
+    static constexpr unsigned all = 0xf;
+    static reg load(const int* p) noexcept
+    { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static reg set1(int v) noexcept { return _mm_set1_epi32(v); }
+    static unsigned bits(reg r) noexcept
+    { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(r))); }
+    static unsigned eq(reg a, reg b) noexcept { return bits(_mm_cmpeq_epi32(a, b)); }
+    static unsigned gt(reg a, reg b) noexcept { return bits(_mm_cmpgt_epi32(a, b)); }
+};
+
+template <>
+struct lanes_<float> {
+    using reg = __m128;
+    static constexpr std::size_t width = 4;
+    static reg load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static reg set1(float v) noexcept { return _mm_set1_ps(v); }
+    static unsigned bits(reg r) noexcept { return static_cast<unsigned>(_mm_movemask_ps(r)); }
+    static reg eq(reg a, reg b) noexcept { return _mm_cmpeq_ps(a, b); }
+    static reg ne(reg a, reg b) noexcept { return _mm_cmpneq_ps(a, b); }
+    static reg lt(reg a, reg b) noexcept { return _mm_cmplt_ps(a, b); }
+    static reg le(reg a, reg b) noexcept { return _mm_cmple_ps(a, b); }
+};
+
+template <>
+struct lanes_<double> {
+    using reg = __m128d;
+    static constexpr std::size_t width = 2;
+    static reg load(const double* p) noexcept { return _mm_loadu_pd(p); }
+    static reg set1(double v) noexcept { return _mm_set1_pd(v); }
+    static unsigned bits(reg r) noexcept { return static_cast<unsigned>(_mm_movemask_pd(r)); }
+    static reg eq(reg a, reg b) noexcept { return _mm_cmpeq_pd(a, b); }
+    static reg ne(reg a, reg b) noexcept { return _mm_cmpneq_pd(a, b); }
+    static reg lt(reg a, reg b) noexcept { return _mm_cmplt_pd(a, b); }
+    static reg le(reg a, reg b) noexcept { return _mm_cmple_pd(a, b); }
+};
+
+template <cmp_op Op, typename T>
+unsigned fp_mask_(typename lanes_<T>::reg a, typename lanes_<T>::reg b) noexcept {
+    using L = lanes_<T>;
+    switch (Op) {
+    case cmp_op::eq: return L::bits(L::eq(a, b));
+    case cmp_op::ne: return L::bits(L::ne(a, b));
+    case cmp_op::lt: return L::bits(L::lt(a, b));
+    case cmp_op::le: return L::bits(L::le(a, b));
+    case cmp_op::gt: return L::bits(L::lt(b, a));
+    case cmp_op::ge: return L::bits(L::le(b, a));
+    }
+    return 0;
+}
+
+#define IMM_SIMD_ENABLED 1
+
+#endif
+
+#ifdef IMM_SIMD_ENABLED
+
+// one bit per lane where `e Op v` holds
+
+template <cmp_op Op, typename T>
+struct mask_ {
+    static unsigned apply(typename lanes_<T>::reg e, typename lanes_<T>::reg v) noexcept
+    { return fp_mask_<Op, T>(e, v); }
+};
+
+// integers only have == and >, the other comparisons are derived
+template <cmp_op Op>
+struct mask_<Op, int> {
+    using L = lanes_<int>;
+    static unsigned apply(L::reg e, L::reg v) noexcept {
+        switch (Op) {
+        case cmp_op::eq: return L::eq(e, v);
+        case cmp_op::ne: return L::eq(e, v) ^ L::all;
+        case cmp_op::lt: return L::gt(v, e);
+        case cmp_op::le: return L::gt(e, v) ^ L::all;
+        case cmp_op::gt: return L::gt(e, v);
+        case cmp_op::ge: return L::gt(v, e) ^ L::all;
+        }
+        return 0;
+    }
+};
+
+#endif
+
+// index of the first element e of p[0..n) such that `e Op v` is equal to
+// Match, n if none. Match is false for for_all, negating the comparison
+// instead would be wrong with NaN.
+template <cmp_op Op,
+          bool Match = true,
+          typename T,
+          typename = std::enable_if_t<is_simd_type<T>::value>>
+std::size_t find_first(const T* p, std::size_t n, T v) noexcept {
+    std::size_t i = 0;
+#ifdef IMM_SIMD_ENABLED
+    using L = lanes_<T>;
+    constexpr unsigned flip = Match ? 0u : (1u << L::width) - 1;
+    auto x = L::set1(v);
+    for (; i + 2 * L::width <= n; i += 2 * L::width) {
+        auto m0 = mask_<Op, T>::apply(L::load(p + i), x) ^ flip;
+        auto m1 = mask_<Op, T>::apply(L::load(p + i + L::width), x) ^ flip;
+        if ((m0 | m1) != 0) {
+            if (m0 != 0) { return i + __builtin_ctz(m0); }
+            return i + L::width + __builtin_ctz(m1);
+        }
+    }
+    for (; i + L::width <= n; i += L::width) {
+        auto m = mask_<Op, T>::apply(L::load(p + i), x) ^ flip;
+        if (m != 0) { return i + __builtin_ctz(m); }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (cmp_<Op, T>::apply(p[i], v) == Match) { return i; }
+    }
+    return n;
+}
+
+} // simd
+
+} // l
+
+#endif // IMM_SIMD_H
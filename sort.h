@@ -0,0 +1,288 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_SORT_H
+#define IMM_SORT_H
+
+#include <list.h>
+#include <flat_list.h>
+#include <functional>
+
+namespace l {
+
+// sorting and sorted set operations. every algorithm works on a flat
+// buffer, both in constant expressions and at run time, cons_ lists are
+// converted to a flat_list first and back once done. elements must be
+// default constructible and copy assignable, less is a strict weak order.
+
+// a sorted sequence of distinct elements, at most N of them. the size of
+// unique and of the set operations depends on the values so it is only
+// known once computed.
+template <typename T, std::size_t N>
+struct flat_set {
+    using value_type = T;
+    constexpr std::size_t size() const noexcept { return n; }
+    T data[N];
+    std::size_t n;
+};
+
+// is flat set helper
+
+template <typename T>
+struct is_flat_set : std::false_type {};
+template <typename T, std::size_t N>
+struct is_flat_set<flat_set<T, N>> : std::true_type {};
+
+// merge the sorted ranges a[0..n) and b[0..m) into out, stable: on
+// equality the element of a comes first.
+template <typename T, typename Less>
+constexpr void sort_merge_(const T* a, std::size_t n,
+                           const T* b, std::size_t m,
+                           T* out, Less& less) {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < n && j < m) {
+        if (less(b[j], a[i])) { *out++ = b[j++]; } else { *out++ = a[i++]; }
+    }
+    while (i < n) { *out++ = a[i++]; }
+    while (j < m) { *out++ = b[j++]; }
+}
+
+// bottom up merge sort of p[0..N), the runs are merged back and forth
+// between p and a temporary buffer.
+template <typename T, std::size_t N, typename Less>
+constexpr void sort_(T (&p)[N], Less& less) {
+    T tmp[N]{};
+    T* from = p;
+    T* to = tmp;
+    for (std::size_t w = 1; w < N; w *= 2) {
+        for (std::size_t lo = 0; lo < N; lo += 2 * w) {
+            auto mid = lo + w < N ? lo + w : N;
+            auto hi = lo + 2 * w < N ? lo + 2 * w : N;
+            sort_merge_(from + lo, mid - lo, from + mid, hi - mid, to + lo, less);
+        }
+        auto t = from;
+        from = to;
+        to = t;
+    }
+    if (from != p) {
+        for (std::size_t i = 0; i < N; ++i) { p[i] = from[i]; }
+    }
+}
+
+// sort
+
+template <typename Less, typename T, std::size_t N>
+constexpr auto sort(Less less, flat_list<T, N> l) -> flat_list<T, N> {
+    sort_(l.data, less);
+    return l;
+}
+
+template <typename T, std::size_t N>
+constexpr auto sort(const flat_list<T, N>& l) -> flat_list<T, N>
+{ return sort(std::less<>{}, l); }
+
+template <typename Less,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto sort(Less less, const L& l) -> L
+{ return to_cons(sort(less, to_flat(l))); }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto sort(const L& l) -> L
+{ return sort(std::less<>{}, l); }
+
+// merge two sorted lists
+
+template <typename Less, typename T, std::size_t N, std::size_t M>
+constexpr auto merge(Less less, const flat_list<T, N>& l1, const flat_list<T, M>& l2)
+    -> flat_list<T, N + M>
+{
+    flat_list<T, N + M> r{};
+    sort_merge_(l1.data, N, l2.data, M, r.data, less);
+    return r;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto merge(const flat_list<T, N>& l1, const flat_list<T, M>& l2)
+    -> flat_list<T, N + M>
+{ return merge(std::less<>{}, l1, l2); }
+
+template <typename Less,
+          typename L1,
+          typename L2,
+          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
+          typename = std::enable_if_t<l::is_imm_list<L2>::value>>
+constexpr auto merge(Less less, const L1& l1, const L2& l2)
+{ return to_cons(merge(less, to_flat(l1), to_flat(l2))); }
+
+template <typename L1,
+          typename L2,
+          typename = std::enable_if_t<l::is_imm_list<L1>::value>,
+          typename = std::enable_if_t<l::is_imm_list<L2>::value>>
+constexpr auto merge(const L1& l1, const L2& l2)
+{ return merge(std::less<>{}, l1, l2); }
+
+// unique, the distinct elements of a list in sorted order
+
+template <typename Less, typename T, std::size_t N>
+constexpr auto unique(Less less, flat_list<T, N> l) -> flat_set<T, N> {
+    sort_(l.data, less);
+    flat_set<T, N> r{};
+    for (std::size_t i = 0; i < N; ++i) {
+        if (r.n == 0 || less(r.data[r.n - 1], l.data[i])) { r.data[r.n++] = l.data[i]; }
+    }
+    return r;
+}
+
+template <typename T, std::size_t N>
+constexpr auto unique(const flat_list<T, N>& l) -> flat_set<T, N>
+{ return unique(std::less<>{}, l); }
+
+template <typename Less,
+          typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto unique(Less less, const L& l)
+{ return unique(less, to_flat(l)); }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto unique(const L& l)
+{ return unique(std::less<>{}, to_flat(l)); }
+
+// set operations, both sets must be ordered by the same less
+
+template <typename Less, typename T, std::size_t N, std::size_t M>
+constexpr auto set_union(Less less, const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N + M>
+{
+    flat_set<T, N + M> r{};
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < s1.n && j < s2.n) {
+        if (less(s1.data[i], s2.data[j])) { r.data[r.n++] = s1.data[i++]; }
+        else if (less(s2.data[j], s1.data[i])) { r.data[r.n++] = s2.data[j++]; }
+        else { r.data[r.n++] = s1.data[i++]; j += 1; }
+    }
+    while (i < s1.n) { r.data[r.n++] = s1.data[i++]; }
+    while (j < s2.n) { r.data[r.n++] = s2.data[j++]; }
+    return r;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto set_union(const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N + M>
+{ return set_union(std::less<>{}, s1, s2); }
+
+template <typename Less, typename T, std::size_t N, std::size_t M>
+constexpr auto set_intersection(Less less, const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N>
+{
+    flat_set<T, N> r{};
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < s1.n && j < s2.n) {
+        if (less(s1.data[i], s2.data[j])) { i += 1; }
+        else if (less(s2.data[j], s1.data[i])) { j += 1; }
+        else { r.data[r.n++] = s1.data[i++]; j += 1; }
+    }
+    return r;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto set_intersection(const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N>
+{ return set_intersection(std::less<>{}, s1, s2); }
+
+// elements of s1 which are not in s2
+template <typename Less, typename T, std::size_t N, std::size_t M>
+constexpr auto set_difference(Less less, const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N>
+{
+    flat_set<T, N> r{};
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < s1.n) {
+        if (j == s2.n || less(s1.data[i], s2.data[j])) { r.data[r.n++] = s1.data[i++]; }
+        else if (less(s2.data[j], s1.data[i])) { j += 1; }
+        else { i += 1; j += 1; }
+    }
+    return r;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+constexpr auto set_difference(const flat_set<T, N>& s1, const flat_set<T, M>& s2)
+    -> flat_set<T, N>
+{ return set_difference(std::less<>{}, s1, s2); }
+
+// binary search
+
+// position of the first element of p[0..n) not less than a
+template <typename T, typename Less>
+constexpr std::size_t lower_bound_(const T* p, std::size_t n, const T& a, Less& less) {
+    std::size_t lo = 0;
+    std::size_t hi = n;
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        if (less(p[mid], a)) { lo = mid + 1; } else { hi = mid; }
+    }
+    return lo;
+}
+
+// the set must be ordered by <
+template <typename T, std::size_t N>
+constexpr bool mem(const T& a, const flat_set<T, N>& s) {
+    std::less<> less{};
+    auto i = lower_bound_(s.data, s.n, a, less);
+    return i != s.n && not less(a, s.data[i]);
+}
+
+// mem on a flat_list sorted with <, O(log N) instead of the linear mem
+template <typename T, std::size_t N>
+constexpr bool mem_sorted(const T& a, const flat_list<T, N>& l) {
+    std::less<> less{};
+    auto i = lower_bound_(l.data, N, a, less);
+    return i != N && not less(a, l.data[i]);
+}
+
+// iter
+
+template <typename T, std::size_t N, typename Fn>
+constexpr void iter(Fn f, const flat_set<T, N>& s) {
+    for (std::size_t i = 0; i < s.n; ++i) { f(s.data[i]); }
+}
+
+} // l
+
+template <typename T, std::size_t N>
+std::ostream& operator<<(std::ostream& os, const l::flat_set<T, N>& s) {
+    os << "{";
+    for (std::size_t i = 0; i < s.n; ++i) {
+        os << s.data[i];
+        if (i + 1 != s.n) { os << ", "; }
+    }
+    os << "}";
+    return os;
+}
+
+#endif // IMM_SORT_H
@@ -0,0 +1,229 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_STATS_H
+#define IMM_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+// instrumentation of the list operations, disabled unless the code is
+// compiled with -DIMM_STATS=1. when disabled every hook expands to
+// nothing and the operations are unchanged. when enabled the hooks are
+// skipped during constant evaluation so constexpr lists keep working.
+#ifndef IMM_STATS
+#define IMM_STATS 0
+#endif
+
+// true while a constexpr function is evaluated by the compiler.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define IMM_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#ifndef IMM_IS_CONSTANT_EVALUATED
+#define IMM_IS_CONSTANT_EVALUATED() true
+#endif
+
+#if IMM_STATS
+#define IMM_STATS_HOOK(...) (IMM_IS_CONSTANT_EVALUATED() ? void() : ::l::stats::__VA_ARGS__)
+#else
+#define IMM_STATS_HOOK(...) void()
+#endif
+
+namespace l {
+
+namespace stats {
+
+constexpr bool enabled = IMM_STATS != 0;
+
+enum class op : std::size_t { rev, append, map, mapi, iter, exists, for_all, find, zip, count };
+
+// counters of one operation. nodes, copies and moves include the nodes of
+// the tail a new list is built on (the second list of append), in_place
+// are the elements constructed in place from the results of a function
+// (map), callbacks are the calls of the user function or predicate,
+// max_depth the deepest recursion of the operation, ns the time measured
+// by timed().
+struct counters {
+    std::uint64_t calls;
+    std::uint64_t nodes;
+    std::uint64_t copies;
+    std::uint64_t moves;
+    std::uint64_t in_place;
+    std::uint64_t callbacks;
+    std::uint64_t max_depth;
+    std::uint64_t ns;
+};
+
+// shared by all threads, updates are relaxed
+struct slot_ {
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> nodes;
+    std::atomic<std::uint64_t> copies;
+    std::atomic<std::uint64_t> moves;
+    std::atomic<std::uint64_t> in_place;
+    std::atomic<std::uint64_t> callbacks;
+    std::atomic<std::uint64_t> max_depth;
+    std::atomic<std::uint64_t> ns;
+};
+
+inline slot_* table_() noexcept {
+    static slot_ t[static_cast<std::size_t>(op::count)] = {};
+    return t;
+}
+
+inline slot_& slot_of_(op o) noexcept
+{ return table_()[static_cast<std::size_t>(o)]; }
+
+// recursion depth of the query running on this thread, one per operation
+inline std::uint64_t& depth_of_(op o) noexcept {
+    static thread_local std::uint64_t d[static_cast<std::size_t>(op::count)] = {};
+    return d[static_cast<std::size_t>(o)];
+}
+
+inline void add_(std::atomic<std::uint64_t>& c, std::uint64_t n) noexcept
+{ c.fetch_add(n, std::memory_order_relaxed); }
+
+inline void max_(std::atomic<std::uint64_t>& c, std::uint64_t n) noexcept {
+    auto cur = c.load(std::memory_order_relaxed);
+    while (cur < n && not c.compare_exchange_weak(cur, n, std::memory_order_relaxed)) {}
+}
+
+// number of lvalue references in Es, elements forwarded as lvalues are copied
+template <typename... Es>
+struct lvalues_ : std::integral_constant<std::size_t, 0> {};
+template <typename E, typename... Es>
+struct lvalues_<E, Es...> : std::integral_constant<std::size_t,
+    std::is_lvalue_reference<E>::value + lvalues_<Es...>::value> {};
+
+// hooks, only called through IMM_STATS_HOOK
+
+// a new list of n elements was built, copies of them copied
+inline void build_(op o, std::size_t n, std::size_t copies) noexcept {
+    auto& s = slot_of_(o);
+    add_(s.calls, 1);
+    add_(s.nodes, n);
+    add_(s.copies, copies);
+    add_(s.moves, n - copies);
+    max_(s.max_depth, n);
+}
+
+// a new list of n elements was constructed in place, nothing copied or moved
+inline void build_in_place_(op o, std::size_t n) noexcept {
+    auto& s = slot_of_(o);
+    add_(s.calls, 1);
+    add_(s.nodes, n);
+    add_(s.in_place, n);
+    max_(s.max_depth, n);
+}
+
+// the tail of a new list was copied (or moved) with its n nodes
+inline void tail_(op o, std::size_t n, bool copied) noexcept {
+    auto& s = slot_of_(o);
+    add_(s.nodes, n);
+    add_(copied ? s.copies : s.moves, n);
+}
+
+inline void callback_(op o, std::size_t n = 1) noexcept
+{ add_(slot_of_(o).callbacks, n); }
+
+// a query walking a list (iter, exists, find...) starts
+inline void query_(op o) noexcept {
+    add_(slot_of_(o).calls, 1);
+    depth_of_(o) = 0;
+}
+
+// the query calls its function one level deeper
+inline void step_(op o) noexcept {
+    auto& s = slot_of_(o);
+    add_(s.callbacks, 1);
+    max_(s.max_depth, ++depth_of_(o));
+}
+
+// api
+
+inline const char* name(op o) noexcept {
+    static const char* names[] = {
+        "rev", "append", "map", "mapi", "iter", "exists", "for_all", "find", "zip"
+    };
+    return o < op::count ? names[static_cast<std::size_t>(o)] : "?";
+}
+
+inline counters get(op o) noexcept {
+    auto& s = slot_of_(o);
+    auto r = [](const std::atomic<std::uint64_t>& c) { return c.load(std::memory_order_relaxed); };
+    return counters{r(s.calls), r(s.nodes), r(s.copies), r(s.moves),
+                    r(s.in_place), r(s.callbacks), r(s.max_depth), r(s.ns)};
+}
+
+inline void reset() noexcept {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(op::count); ++i) {
+        auto& s = table_()[i];
+        for (auto c : {&s.calls, &s.nodes, &s.copies, &s.moves, &s.in_place, &s.callbacks, &s.max_depth, &s.ns}) {
+            c->store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// run f and add its duration to the counters of o, f alone when disabled
+template <typename Fn>
+auto timed(op o, Fn f) -> decltype(f()) {
+#if IMM_STATS
+    struct timer_ {
+        ~timer_() {
+            auto d = std::chrono::steady_clock::now() - start;
+            add_(slot_of_(o).ns, static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+        }
+        op o;
+        std::chrono::steady_clock::time_point start;
+    } t{o, std::chrono::steady_clock::now()};
+#else
+    (void)o;
+#endif
+    return f();
+}
+
+// one line per operation used since the last reset
+inline std::ostream& report(std::ostream& os) {
+    for (std::size_t i = 0; i < static_cast<std::size_t>(op::count); ++i) {
+        auto c = get(static_cast<op>(i));
+        if (c.calls == 0 && c.callbacks == 0 && c.ns == 0) { continue; }
+        os << name(static_cast<op>(i)) << ": calls " << c.calls
+           << ", nodes " << c.nodes << ", copies " << c.copies
+           << ", moves " << c.moves << ", in_place " << c.in_place
+           << ", callbacks " << c.callbacks
+           << ", max_depth " << c.max_depth << ", ns " << c.ns << "\n";
+    }
+    return os;
+}
+
+} // stats
+
+} // l
+
+#endif // IMM_STATS_H
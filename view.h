@@ -0,0 +1,305 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_VIEW_H
+#define IMM_VIEW_H
+
+#include <list.h>
+#include <flat_list.h>
+
+namespace l {
+
+// lazy views over a homogeneous list:
+//
+//   l::view(a) | l::map(f) | l::filter(p) | l::take<3>()
+//
+// nothing is computed until the view is consumed by iter, exists,
+// for_all, find, to_flat or to_cons. each element is then pushed through
+// all the stages in a single pass, no intermediate list is built.
+// everything is constexpr as long as the functions are.
+
+// push the elements of the source list to a sink, stop when it returns false
+
+template <typename Sink>
+constexpr bool view_push_(nil_t, Sink&) { return true; }
+
+template <typename Head, typename Tail, typename Sink>
+constexpr bool view_push_(const cons_<Head, Tail>& l, Sink& s)
+{ return s(l.h) && view_push_(l.t, s); }
+
+template <typename T, std::size_t N, typename Sink>
+constexpr bool view_push_(const flat_list<T, N>& l, Sink& s) {
+    for (std::size_t i = 0; i < N; ++i) {
+        if (not s(l.data[i])) { return false; }
+    }
+    return true;
+}
+
+// the source list, only referenced so it must outlive the view
+
+template <typename L>
+struct view_source_ {
+    using value_type = typename L::head_type;
+    static constexpr std::size_t max_size = length<L>::value;
+    static constexpr bool exact = true;
+    template <typename Sink>
+    constexpr bool run(Sink& s) const { return view_push_(l, s); }
+    const L& l;
+};
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value || l::is_flat_list<L>::value>>
+constexpr view_source_<L> view(const L& l) noexcept
+{ return view_source_<L>{l}; }
+
+// a view of a temporary list would outlive it
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value || l::is_flat_list<L>::value>>
+void view(const L&&) = delete;
+
+// stages
+
+template <typename Fn, typename Next>
+struct map_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) { return next(f(e)); }
+    const Fn& f;
+    Next& next;
+};
+
+template <typename Fn>
+struct map_stage_ {
+    template <typename T>
+    using value_type = std::decay_t<decltype(std::declval<const Fn&>()(std::declval<const T&>()))>;
+    static constexpr std::size_t max_size(std::size_t n) { return n; }
+    static constexpr bool exact(bool e) { return e; }
+    template <typename Next>
+    constexpr map_sink_<Fn, Next> wrap(Next& next) const { return map_sink_<Fn, Next>{f, next}; }
+    Fn f;
+};
+
+template <typename Fn, typename Next>
+struct filter_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) { return f(e) ? next(e) : true; }
+    const Fn& f;
+    Next& next;
+};
+
+template <typename Fn>
+struct filter_stage_ {
+    template <typename T>
+    using value_type = T;
+    static constexpr std::size_t max_size(std::size_t n) { return n; }
+    static constexpr bool exact(bool) { return false; }
+    template <typename Next>
+    constexpr filter_sink_<Fn, Next> wrap(Next& next) const { return filter_sink_<Fn, Next>{f, next}; }
+    Fn f;
+};
+
+template <std::size_t N, typename Next>
+struct take_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) {
+        if (n == N) { return false; }
+        n += 1;
+        return next(e) && n < N;
+    }
+    Next& next;
+    std::size_t n;
+};
+
+// the size is exact only if the source has at least N elements
+template <std::size_t N>
+struct take_stage_ {
+    template <typename T>
+    using value_type = T;
+    static constexpr std::size_t max_size(std::size_t n) { return n < N ? n : N; }
+    static constexpr bool exact(bool e) { return e; }
+    template <typename Next>
+    constexpr take_sink_<N, Next> wrap(Next& next) const { return take_sink_<N, Next>{next, 0}; }
+};
+
+template <typename Fn>
+constexpr map_stage_<Fn> map(Fn f) noexcept { return map_stage_<Fn>{f}; }
+
+template <typename Fn>
+constexpr filter_stage_<Fn> filter(Fn f) noexcept { return filter_stage_<Fn>{f}; }
+
+template <std::size_t N>
+constexpr take_stage_<N> take() noexcept { return take_stage_<N>{}; }
+
+// a view with one more stage
+
+template <typename Src, typename Stage>
+struct view_ {
+    using value_type = typename Stage::template value_type<typename Src::value_type>;
+    static constexpr std::size_t max_size = Stage::max_size(Src::max_size);
+    static constexpr bool exact = Stage::exact(Src::exact);
+    template <typename Sink>
+    constexpr bool run(Sink& s) const {
+        auto w = stage.wrap(s);
+        return src.run(w);
+    }
+    Src src;
+    Stage stage;
+};
+
+// is view helper
+
+template <typename T>
+struct is_view : std::false_type {};
+template <typename L>
+struct is_view<view_source_<L>> : std::true_type {};
+template <typename Src, typename Stage>
+struct is_view<view_<Src, Stage>> : std::true_type {};
+
+template <typename T>
+struct is_view_stage : std::false_type {};
+template <typename Fn>
+struct is_view_stage<map_stage_<Fn>> : std::true_type {};
+template <typename Fn>
+struct is_view_stage<filter_stage_<Fn>> : std::true_type {};
+template <std::size_t N>
+struct is_view_stage<take_stage_<N>> : std::true_type {};
+
+template <typename V,
+          typename Stage,
+          typename = std::enable_if_t<is_view<V>::value>,
+          typename = std::enable_if_t<is_view_stage<Stage>::value>>
+constexpr view_<V, Stage> operator|(const V& v, const Stage& s) noexcept
+{ return view_<V, Stage>{v, s}; }
+
+// consumers
+
+template <typename Fn>
+struct iter_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) { f(e); return true; }
+    Fn& f;
+};
+
+template <typename Fn,
+          typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr void iter(Fn f, const V& v) {
+    iter_sink_<Fn> s{f};
+    v.run(s);
+}
+
+template <typename Fn>
+struct exists_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) {
+        found = f(e);
+        return not found;
+    }
+    Fn& f;
+    bool found;
+};
+
+template <typename Fn,
+          typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr bool exists(Fn f, const V& v) {
+    exists_sink_<Fn> s{f, false};
+    v.run(s);
+    return s.found;
+}
+
+template <typename Fn>
+struct for_all_sink_ {
+    template <typename T>
+    constexpr bool operator()(const T& e) {
+        ok = f(e);
+        return ok;
+    }
+    Fn& f;
+    bool ok;
+};
+
+template <typename Fn,
+          typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr bool for_all(Fn f, const V& v) {
+    for_all_sink_<Fn> s{f, true};
+    v.run(s);
+    return s.ok;
+}
+
+template <typename Fn, typename T>
+struct find_sink_ {
+    constexpr bool operator()(const T& e) {
+        if (not f(e)) { return true; }
+        r = e;
+        found = true;
+        return false;
+    }
+    Fn& f;
+    T r;
+    bool found;
+};
+
+// the value type must be default constructible
+template <typename Fn,
+          typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr auto find(Fn f, const V& v) -> typename V::value_type {
+    find_sink_<Fn, typename V::value_type> s{f, typename V::value_type{}, false};
+    v.run(s);
+    if (not s.found) { throw not_found{}; }
+    return s.r;
+}
+
+// collect, only for views which size is known at compile time (no filter).
+// the value type must be default constructible.
+
+template <typename T, std::size_t N>
+struct collect_sink_ {
+    constexpr bool operator()(const T& e) {
+        out.data[i] = e;
+        i += 1;
+        return true;
+    }
+    flat_list<T, N>& out;
+    std::size_t i;
+};
+
+template <typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr auto to_flat(const V& v) -> flat_list<typename V::value_type, V::max_size> {
+    static_assert(V::exact, "the size of a filtered view is not known at compile time");
+    flat_list<typename V::value_type, V::max_size> r{};
+    collect_sink_<typename V::value_type, V::max_size> s{r, 0};
+    v.run(s);
+    return r;
+}
+
+template <typename V,
+          typename = std::enable_if_t<is_view<V>::value>>
+constexpr auto to_cons(const V& v)
+    -> typename list_type_from_size<typename V::value_type, V::max_size>::type
+{ return to_cons(to_flat(v)); }
+
+} // l
+
+#endif // IMM_VIEW_H
@@ -0,0 +1,241 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Jeremy Letang
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IMM_VLIST_H
+#define IMM_VLIST_H
+
+#include <list.h>
+#include <utility>
+
+namespace l {
+
+// heterogeneous list built from a parameter pack. every element is stored
+// in its own indexed base, so all the operations below are pack expansions
+// and never recurse once per element.
+
+template <std::size_t I, typename T>
+struct vlist_leaf_ {
+    constexpr explicit vlist_leaf_(const T& v)
+    : v(v) {}
+    T v;
+};
+
+template <typename Seq, typename... Ts>
+struct vlist_impl_;
+
+template <std::size_t... I, typename... Ts>
+struct vlist_impl_<std::index_sequence<I...>, Ts...> : vlist_leaf_<I, Ts>... {
+    constexpr explicit vlist_impl_(const Ts&... vs)
+    : vlist_leaf_<I, Ts>(vs)... {}
+};
+
+template <typename... Ts>
+struct vlist : vlist_impl_<std::index_sequence_for<Ts...>, Ts...> {
+    constexpr explicit vlist(const Ts&... vs)
+    : vlist_impl_<std::index_sequence_for<Ts...>, Ts...>(vs...) {}
+};
+
+template <typename... Ts>
+constexpr vlist<Ts...> make_vlist(const Ts&... vs)
+{ return vlist<Ts...>{vs...}; }
+
+// is vlist helper
+
+template <typename T>
+struct is_vlist : std::false_type {};
+template <typename... Ts>
+struct is_vlist<vlist<Ts...>> : std::true_type {};
+
+// get the list size
+
+template <std::size_t N, typename... Ts>
+struct length_<N, vlist<Ts...>> {
+    static constexpr std::size_t value = N + sizeof...(Ts);
+};
+
+// element access, the leaf is selected by overload resolution on the base
+// class so there is no recursion at all.
+
+template <std::size_t I, typename T>
+constexpr const T& vlist_get_(const vlist_leaf_<I, T>& l) noexcept
+{ return l.v; }
+
+template <std::size_t I, typename T>
+T vlist_element_(const vlist_leaf_<I, T>&);
+
+template <std::size_t I, typename L>
+using vlist_element_t = decltype(vlist_element_<I>(std::declval<const L&>()));
+
+// nth
+
+template <std::size_t N,
+          typename... Ts,
+          typename = std::enable_if_t<(N < sizeof...(Ts))>>
+constexpr auto nth(const vlist<Ts...>& l) noexcept -> vlist_element_t<N, vlist<Ts...>>
+{ return vlist_get_<N>(l); }
+
+// hd / tl
+
+template <typename Head, typename... Tail>
+constexpr auto hd(const vlist<Head, Tail...>& l) noexcept -> Head
+{ return vlist_get_<0>(l); }
+
+template <typename... Ts, std::size_t... I>
+constexpr auto vlist_tl_(const vlist<Ts...>& l, std::index_sequence<I...>) noexcept
+    -> vlist<vlist_element_t<I + 1, vlist<Ts...>>...>
+{ return vlist<vlist_element_t<I + 1, vlist<Ts...>>...>{vlist_get_<I + 1>(l)...}; }
+
+template <typename Head, typename... Tail>
+constexpr auto tl(const vlist<Head, Tail...>& l) noexcept -> vlist<Tail...>
+{ return vlist_tl_(l, std::index_sequence_for<Tail...>{}); }
+
+// iter
+
+template <typename Fn, typename... Ts, std::size_t... I>
+void vlist_iter_(Fn& f, const vlist<Ts...>& l, std::index_sequence<I...>) {
+    using expand = int[];
+    (void)expand{0, ((void)f(vlist_get_<I>(l)), 0)...};
+}
+
+template <typename Fn, typename... Ts>
+void iter(Fn f, const vlist<Ts...>& l)
+{ vlist_iter_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// iteri
+
+template <typename Fn, typename... Ts, std::size_t... I>
+void vlist_iteri_(Fn& f, const vlist<Ts...>& l, std::index_sequence<I...>) {
+    using expand = int[];
+    (void)expand{0, ((void)f(I, vlist_get_<I>(l)), 0)...};
+}
+
+template <typename Fn, typename... Ts>
+void iteri(Fn f, const vlist<Ts...>& l)
+{ vlist_iteri_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// map, elements are evaluated from left to right (braced init)
+
+template <typename Fn, typename... Ts, std::size_t... I>
+constexpr auto vlist_map_(Fn f, const vlist<Ts...>& l, std::index_sequence<I...>) noexcept
+    -> vlist<decltype(f(std::declval<const Ts&>()))...>
+{ return vlist<decltype(f(std::declval<const Ts&>()))...>{f(vlist_get_<I>(l))...}; }
+
+template <typename Fn, typename... Ts>
+constexpr auto map(Fn f, const vlist<Ts...>& l) noexcept
+    -> vlist<decltype(f(std::declval<const Ts&>()))...>
+{ return vlist_map_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// mapi
+
+template <typename Fn, typename... Ts, std::size_t... I>
+constexpr auto vlist_mapi_(Fn f, const vlist<Ts...>& l, std::index_sequence<I...>) noexcept
+    -> vlist<decltype(f(I, std::declval<const Ts&>()))...>
+{ return vlist<decltype(f(I, std::declval<const Ts&>()))...>{f(I, vlist_get_<I>(l))...}; }
+
+template <typename Fn, typename... Ts>
+constexpr auto mapi(Fn f, const vlist<Ts...>& l) noexcept
+    -> decltype(vlist_mapi_(f, l, std::index_sequence_for<Ts...>{}))
+{ return vlist_mapi_(f, l, std::index_sequence_for<Ts...>{}); }
+
+// rev
+
+template <typename... Ts, std::size_t... I>
+constexpr auto vlist_rev_(const vlist<Ts...>& l, std::index_sequence<I...>) noexcept
+    -> vlist<vlist_element_t<sizeof...(Ts) - 1 - I, vlist<Ts...>>...>
+{
+    return vlist<vlist_element_t<sizeof...(Ts) - 1 - I, vlist<Ts...>>...>{
+        vlist_get_<sizeof...(Ts) - 1 - I>(l)...
+    };
+}
+
+template <typename... Ts>
+constexpr auto rev(const vlist<Ts...>& l) noexcept
+    -> decltype(vlist_rev_(l, std::index_sequence_for<Ts...>{}))
+{ return vlist_rev_(l, std::index_sequence_for<Ts...>{}); }
+
+// append
+
+template <typename... Ts, typename... Us, std::size_t... I, std::size_t... J>
+constexpr auto vlist_append_(const vlist<Ts...>& l1,
+                             const vlist<Us...>& l2,
+                             std::index_sequence<I...>,
+                             std::index_sequence<J...>) noexcept
+    -> vlist<Ts..., Us...>
+{ return vlist<Ts..., Us...>{vlist_get_<I>(l1)..., vlist_get_<J>(l2)...}; }
+
+template <typename... Ts, typename... Us>
+constexpr auto append(const vlist<Ts...>& l1, const vlist<Us...>& l2) noexcept
+    -> vlist<Ts..., Us...>
+{
+    return vlist_append_(l1, l2,
+                         std::index_sequence_for<Ts...>{},
+                         std::index_sequence_for<Us...>{});
+}
+
+template <typename... Ts, typename... Us>
+constexpr auto rev_append(const vlist<Ts...>& l1, const vlist<Us...>& l2) noexcept
+    -> decltype(append(rev(l1), l2))
+{ return append(rev(l1), l2); }
+
+// conversion from a cons_ list, the list is indexed once by elem_refs_
+// then the vlist is built from a single pack of indices.
+
+template <typename R, std::size_t... I>
+constexpr auto to_vlist_(const R& r, std::index_sequence<I...>) noexcept
+    -> vlist<elem_ref_t_<I, R>...>
+{ return vlist<elem_ref_t_<I, R>...>{elem_ref_get_<I>(r)...}; }
+
+template <typename L,
+          typename = std::enable_if_t<l::is_imm_list<L>::value>>
+constexpr auto to_vlist(const L& l) noexcept
+{ return to_vlist_(elem_refs_<0, L>(l), std::make_index_sequence<length<L>::value>{}); }
+
+// conversion to a cons_ list, each node is built in place by the index_<I>
+// constructor from the I-th leaf, copied once.
+
+template <typename... Ts>
+struct vlist_src_ {
+    template <std::size_t I>
+    constexpr auto get() const noexcept -> const vlist_element_t<I, vlist<Ts...>>&
+    { return vlist_get_<I>(l); }
+    const vlist<Ts...>& l;
+};
+
+template <typename Head, typename... Tail>
+constexpr auto to_cons(const vlist<Head, Tail...>& l) noexcept
+    -> typename list_type_from_types<Head, Tail...>::type
+{ return typename list_type_from_types<Head, Tail...>::type(index_<0>{}, vlist_src_<Head, Tail...>{l}); }
+
+} // l
+
+template <typename... Ts>
+std::ostream& operator<<(std::ostream& os, const l::vlist<Ts...>& l) {
+    os << "[";
+    l::iteri([&](std::size_t i, const auto& e) {
+        os << e;
+        if (i + 1 != sizeof...(Ts)) { os << ", "; }
+    }, l);
+    os << "]";
+    return os;
+}
+
+#endif // IMM_VLIST_H